@@ -940,6 +940,8 @@ void Access::RedrawWnd(GeneralError* external_err_ptr)
 		
 		if (iClientX == iLeft) return;
 
+		std::vector<double> vZ(iClientX - iLeft + 1), vPF(vZ.size());
+
 		for (int iIndex = iLeft; iIndex <= iClientX; ++iIndex)
 		{
 			auto dZ{ (iIndex - iLeft) * Graph.area() / (iClientX - iLeft) };
@@ -947,7 +949,14 @@ void Access::RedrawWnd(GeneralError* external_err_ptr)
 			if (dZ < 0.0) dZ = 0.0;
 			if (dZ > Graph.area()) dZ = Graph.area();
 
-			auto dPF{ ((iBottom - iTop) / dGraphFactor) * Graph(dZ) };
+			vZ[iIndex - iLeft] = dZ;
+		}
+
+		Graph.pf(vZ.data(), vZ.size(), vPF.data());
+
+		for (int iIndex = iLeft; iIndex <= iClientX; ++iIndex)
+		{
+			auto dPF{ ((iBottom - iTop) / dGraphFactor) * vPF[iIndex - iLeft] };
 
 			dc.LineTo(iIndex, iBottom - int(dPF));
 		}
@@ -1068,9 +1077,11 @@ void Access::ProcessLeftClick(int uMouseX, int uMouseY)
 	{
 		AutoWaitCursor wc{ *this };
 
-		CP.add_vertex(convex_polygon::point(dAppX, dAppY));
-		CP.convex_hull();
-		RemoveMax();
+		// The shortest curve stays valid if the new vertex
+		// lies inside the polygon
+
+		if (CP.insert_vertex(convex_polygon::point(dAppX, dAppY)))
+			RemoveMax();
 	}
 
 	UpdateButtons();
@@ -1191,7 +1202,7 @@ void Access::ProcessFileOpen()
 	double dAppX{}, dAppY{};
 	wchar_t semi_col[2]{};
 	int iResult{};
-	convex_polygon New{};
+	convex_hull_builder New{};
 
 	for (;;) 
 	{
@@ -1221,7 +1232,7 @@ void Access::ProcessFileOpen()
 		return;
 	}
 
-	if (New.num_vertices() < 3)
+	if (New.num_points() < 3)
 	{
 		OnError(1490, AppNotEnoughVertices);
 		return;
@@ -1238,8 +1249,7 @@ void Access::ProcessFileOpen()
 		szFileTitle[uFileTitleBufferSize - 4] = '.';
 	}
 
-	CP = New;
-	CP.convex_hull();
+	CP = New.convex_hull();
 
 	RemoveMax();
 	UpdateButtons();
@@ -1330,8 +1340,7 @@ void Access::ProcessGraph()
 	if (fGraph)
 	{
 		CP.convex_hull();
-		Graph.~convex_polygon_pf();
-		Graph.convex_polygon_pf::convex_polygon_pf(CP);
+		Graph.assign(CP);
 		uNumSegments = Graph.num_segments();
 		fBubbles = true;
 	}
@@ -1745,4 +1754,4 @@ BOOL FillRichEditFromFile(HWND hwnd, LPCTSTR pszFile)
 		CloseHandle(hFile);
 	}
 	return fSuccess;
-}
\ No newline at end of file
+}
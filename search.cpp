@@ -8,27 +8,38 @@
 //				const convex_polygon_pf&, cyclic_uint,
 //				cyclic_uint, eff_perimeter*);
 // 
-// Build options
+// Argument checks
 //
-// The SEARCH_CPP_THROW_RANGE parameter controls the way
-// the functions react to the wrong arguments:
-//
-// If SEARCH_CPP_THROW_RANGE is defined, the functions will throw
+// The functions react to the wrong arguments according to
+// the checking policies defined in search.hpp.  Those without
+// a policy, and the member functions of the classes, throw
 // (1) std::invalid_argument if any of the arguments is NaN;
 // (2) std::out_of_range if any of the arguments is a finite
 // number of +/- infinity but is out of the specified range.
 //
-// If SEARCH_CPP_THROW_RANGE is not defined, the functions will
-// return NaN in all of the above cases.
-//
-
-#define SEARCH_CPP_THROW_RANGE
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
 #include <limits>
+#include <mutex>
+#include <new>
 #include <string>
+#include <thread>
 
 #include "search.hpp"
 
+//
+// SSE2 is used if the compiler targets it
+//
+
+#if defined (__SSE2__) || defined (_M_X64) || \
+	(defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SEARCH_CPP_SSE2
+#endif
+
 namespace search
 {
 	//
@@ -57,6 +68,13 @@ namespace search
 
 	static const double qnan (pos_infinity/pos_infinity);
 
+	//
+	// Turn of the convex hull, in radians, below which a vertex
+	// is taken as lying on a side, see convex_polygon::exact_hull()
+	//
+
+	static const double hull_tolerance (1.0e-10);
+
 	//
 	// Auxiliary function used by **pf_circle functions.
 	// It calculates
@@ -73,103 +91,578 @@ namespace search
 
 	double aux_2 (double beta);
 
-#ifdef SEARCH_CPP_THROW_RANGE
+	//
+	// Call task(index) for index = 0, ... , num_tasks - 1 using
+	// up to num_threads threads (the calling thread included).
+	// The tasks are handed out in increasing order.  If a task
+	// throws, the remaining tasks are not started, and the first
+	// exception is rethrown in the calling thread.
+	//
+
+	void parallel_for (
+		unsigned num_tasks, unsigned num_threads,
+		const std::function<void (unsigned)>& task);
+
+	//
+	// Fill order[node], order[2*node], ... (the subtree of node
+	// in the Eytzinger layout) with the consecutive indices
+	// starting from first, in the in-order traversal.
+	// Returns the next index.
+	//
+
+	unsigned eytzinger_order (
+		std::vector<unsigned>& order, size_t node, unsigned first);
+
+	//
+	// Node of the Eytzinger layout of a sorted array holding the
+	// first element x <= layout[node], or 0 if there is none.
+	// layout[0] is not used.
+	//
+
+	size_t eytzinger_lower_bound (const std::vector<double>& layout, double x);
+
+	//
+	// Root of a monotone function on the interval (left, right)
+	// found by Newton's method safeguarded by bisection, starting
+	// from guess.  function (x, derivative) returns the value at x
+	// and stores the derivative at x.  A step leaving the current
+	// bracket is replaced with a bisection.  The iteration stops
+	// when the step is within the rounding of x, or when the
+	// bracket can't be split any more, in which case its end on
+	// the side of the root is returned.  If the function has no
+	// root in the interval, that is the end of the interval where
+	// the function is closest to 0, as with plain bisection.
+	//
+
+	template <typename Function>
+	double newton (
+		const Function& function, double left, double right,
+		double guess, bool increasing);
+
+	//
+	// Evaluation of a batch of arguments x[0], ... , x[count - 1]
+	// of a perimeter function:  out[k] = function(x[k]) if
+	// 0 <= x[k] <= upper (and x[k] < positive infinity if finite
+	// is set), otherwise out[k] = NaN; in_range (if not null)
+	// receives the results of the test.  Returns the number of
+	// elements out of range.  function is only called for the
+	// valid elements.  The second version evaluates the pairs of
+	// elements with the SSE2 kernel(x[k], x[k + 1]) instead.
+	//
+
+	template <typename Function>
+	size_t batch (
+		const double* x, size_t count, double* out, bool* in_range,
+		double upper, bool finite, const Function& function);
+
+#ifdef SEARCH_CPP_SSE2
+
+	template <typename Function, typename Kernel>
+	size_t batch (
+		const double* x, size_t count, double* out, bool* in_range,
+		double upper, bool finite,
+		const Function& function, const Kernel& kernel);
+
+#endif // SEARCH_CPP_SSE2
+
+	//
+	// The result of a batch function whose common arguments
+	// are invalid:  all the elements are out of range.
+	//
+
+	size_t batch_out_of_range (size_t count, double* out, bool* in_range);
+
+	//
+	// Piecewise Chebyshev approximation of a smooth function on
+	// [lower, upper]:  the interval is split into num_pieces equal
+	// pieces, and on each of them the function is interpolated by
+	// a polynomial of the given degree at the Chebyshev nodes.
+	// Used by the functions of namespace fast.
+	//
+
+	class chebyshev_table {
+
+	public:
+
+		chebyshev_table (
+			const std::function<double (double)>& function,
+			double lower, double upper, unsigned num_pieces, unsigned degree);
+
+		//
+		// Value of the approximation, lower <= x <= upper
+		//
+
+		double operator () (double x) const;
+
+	private:
+
+		double lower;
+		double scale;
+		unsigned num_pieces;
+		unsigned degree;
+
+		//
+		// Chebyshev coefficients, degree + 1 per piece
+		//
+
+		std::vector<double> coefficients;
+	};
+
+	//
+	// Evaluation of a grid out[i*num_r + j], 0 <= i < num_w,
+	// 0 <= j < num_r, of a gain function:  the blocks of rows
+	// first, ... , last - 1 are passed to rows (first, last)
+	// by up to num_threads threads.
+	//
+
+	template <typename Rows>
+	void grid (
+		size_t num_w, size_t num_r, unsigned num_threads, const Rows& rows);
+
+	//
+	// The part of h (w, r, a) depending on r only, r being
+	// already divided by a:  sin(r), cos(r) and the even powers
+	// of r used by the power series.  The grid version of h
+	// shares it among the values of w.
+	//
+
+	class h_column {
+
+	public:
+
+		explicit h_column (double r);
+
+		//
+		// h (w, a*r, a) for 0 <= w <= 1 and 0 < a
+		//
+
+		double operator () (double w, double a) const;
+
+		//
+		// Whether r is not small, so that h is calculated by
+		// the general formula for any w
+		//
+
+		bool regular () const;
+
+#ifdef SEARCH_CPP_SSE2
+
+		//
+		// The same as operator () for a pair of values of w,
+		// if regular () is true
+		//
+
+		__m128d operator () (__m128d w, double a) const;
+
+#endif // SEARCH_CPP_SSE2
+
+	private:
+
+		//
+		// Coefficients of the power series (see operator ())
+		//
+
+		static const double x_numerators [12];
+		static const double x_denominators [12];
+		static const double yz_denominators [10];
+
+		static const double r_limit_1;
+		static const double r_limit_2;
+		static const double r_limit_3;
+
+		double r;
+		double r_abs;
+		double r2;
+		double c;
+		double s;
+
+		//
+		// Even powers of r and the sum of the series for
+		// x (see operator ()), set if |r| <= r_limit_3
+		//
+
+		double p [12];
+		double x_series;
+	};
 
 	//
-	// Range check for inbound arguments
+	// Range check for inbound arguments.  With nan_on_error, it
+	// returns true if cond is false; with throw_on_error, it throws
+	// instead; with unchecked, it is always false and is optimized
+	// away together with the test of cond.
 	//
 
-	bool out_of_range (bool cond, const std::string& name_of_fun)
+	template <typename Policy = throw_on_error>
+	bool out_of_range (bool cond, const char* name_of_fun, Policy = Policy ())
 	{
-		if (!cond)
+		if (!Policy::checked || cond)
+		{
+			return false;
+		}
+
+		if (Policy::throws)
 		{
 			std::string what (name_of_namespace);
 			what += name_of_fun;
 			throw std::out_of_range (what);
 		}
-		else
-		{
-			return false;
-		}
+
+		return true;
 	}
 
 	//
-	// Check for NaN for inbound arguments (3 overloads)
+	// Check for NaN for inbound arguments (3 overloads),
+	// same as above
 	//
 
-	bool is_nan (double x, const std::string& name_of_fun)
+	template <typename Policy = throw_on_error>
+	bool is_nan (double x, const char* name_of_fun, Policy = Policy ())
 	{
-		if (_isnan (x))
+		if (!Policy::checked || !_isnan (x))
+		{
+			return false;
+		}
+
+		if (Policy::throws)
 		{
 			std::string what (name_of_namespace);
 			what += name_of_fun;
 			throw std::invalid_argument (what);
 		}
-		else
+
+		return true;
+	}
+
+	template <typename Policy = throw_on_error>
+	bool is_nan (
+		double x, double y, const char* name_of_fun, Policy policy = Policy ())
+	{
+		return is_nan (x, name_of_fun, policy) || is_nan (y, name_of_fun, policy);
+	}
+
+	template <typename Policy = throw_on_error>
+	bool is_nan (
+		double x, double y, double z, const char* name_of_fun,
+		Policy policy = Policy ())
+	{
+		return is_nan (x, y, name_of_fun, policy) || is_nan (z, name_of_fun, policy);
+	}
+
+	void parallel_for (
+		unsigned num_tasks, unsigned num_threads,
+		const std::function<void (unsigned)>& task)
+	{
+		num_threads = std::min (num_threads, num_tasks);
+
+		if (num_threads <= 1)
 		{
-			return false;
+			for (unsigned index = 0; index < num_tasks; ++index)
+			{
+				task (index);
+			}
+
+			return;
+		}
+
+		std::atomic<unsigned> next (0);
+		std::exception_ptr error;
+		std::mutex error_mutex;
+
+		auto worker = [&] ()
+		{
+			for (unsigned index; (index = next++) < num_tasks; )
+			{
+				try
+				{
+					task (index);
+				}
+				catch (...)
+				{
+					std::lock_guard<std::mutex> lock (error_mutex);
+
+					if (!error)
+					{
+						error = std::current_exception ();
+					}
+
+					next = num_tasks;
+				}
+			}
+		};
+
+		std::vector<std::thread> threads;
+
+		try
+		{
+			while (threads.size () + 1 < num_threads)
+			{
+				threads.push_back (std::thread (worker));
+			}
+		}
+		catch (...)
+		{
+			// go on with the threads that have been started
+		}
+
+		worker ();
+
+		for (std::thread& thread : threads)
+		{
+			thread.join ();
+		}
+
+		if (error)
+		{
+			std::rethrow_exception (error);
 		}
 	}
 
-	bool is_nan (double x, double y, const std::string& name_of_fun)
+	unsigned eytzinger_order (
+		std::vector<unsigned>& order, size_t node, unsigned first)
 	{
-		if (_isnan (x) || _isnan (y))
+		if (node < order.size ())
 		{
-			std::string what (name_of_namespace);
-			what += name_of_fun;
-			throw std::invalid_argument (what);
+			first = eytzinger_order (order, 2*node, first);
+			order [node] = first++;
+			first = eytzinger_order (order, 2*node + 1, first);
 		}
-		else
+
+		return first;
+	}
+
+	size_t eytzinger_lower_bound (const std::vector<double>& layout, double x)
+	{
+		size_t node (1);
+
+		// go left if x <= layout[node], without branches
+		while (node < layout.size ())
 		{
-			return false;
+			node = 2*node + (layout [node] < x);
 		}
+
+		// the answer is where the path turned left for the last
+		// time: drop the trailing right turns and that left turn
+
+		while ((node & 1) != 0)
+		{
+			node >>= 1;
+		}
+
+		return node >> 1;
 	}
 
-	bool is_nan (double x, double y, double z, const std::string& name_of_fun)
+	template <typename Function>
+	double newton (
+		const Function& function, double left, double right,
+		double guess, bool increasing)
 	{
-		if (_isnan (x) || _isnan (y) || _isnan (z))
+		static const double precision (
+			4.0*std::numeric_limits<double>::epsilon ());
+
+		double x (left < guess && guess < right ?
+			guess : left + (right - left)/2.0);
+
+		for (;;)
 		{
-			std::string what (name_of_namespace);
-			what += name_of_fun;
-			throw std::invalid_argument (what);
+			double derivative (0.0);
+			const double value (function (x, derivative));
+
+			if (value == 0.0)
+			{
+				return x;
+			}
+
+			if ((value > 0.0) == increasing)
+			{
+				right = x;
+			}
+			else
+			{
+				left = x;
+			}
+
+			double next (x - value/derivative);
+
+			if (fabs (next - x) <= precision*fabs (x) &&
+				fabs (derivative) < pos_infinity)
+			{
+				return next;
+			}
+
+			if (!(left < next && next < right))
+			{
+				next = left + (right - left)/2.0;
+
+				if (!(left < next && next < right))
+				{
+					return x == left ? right : left;
+				}
+			}
+
+			x = next;
 		}
-		else
+	}
+
+	template <typename Function>
+	size_t batch (
+		const double* x, size_t count, double* out, bool* in_range,
+		double upper, bool finite, const Function& function)
+	{
+		// x <= upper && x < infinity is x <= min(upper, max)
+
+		const double bound (finite ?
+			std::min (upper, std::numeric_limits<double>::max ()) : upper);
+
+		size_t num_out_of_range (0);
+
+		for (size_t k = 0; k < count; ++k)
 		{
-			return false;
+			const bool valid (0.0 <= x [k] && x [k] <= bound);
+
+			out [k] = valid ? function (x [k]) : qnan;
+			num_out_of_range += !valid;
+
+			if (in_range != 0)
+			{
+				in_range [k] = valid;
+			}
 		}
-	}
 
-#else // SEARCH_CPP_THROW_RANGE
+		return num_out_of_range;
+	}
 
-	//
-	// Range check for inbound arguments
-	//
+#ifdef SEARCH_CPP_SSE2
 
-	bool out_of_range (bool cond, const std::string& name_of_fun)
+	template <typename Function, typename Kernel>
+	size_t batch (
+		const double* x, size_t count, double* out, bool* in_range,
+		double upper, bool finite,
+		const Function& function, const Kernel& kernel)
 	{
-		return !cond;
+		const __m128d
+			zero (_mm_setzero_pd ()),
+			bound (_mm_set1_pd (finite ?
+				std::min (upper, std::numeric_limits<double>::max ()) : upper)),
+			nan (_mm_set1_pd (qnan));
+
+		size_t num_out_of_range (0);
+		size_t k (0);
+
+		for (; k + 2 <= count; k += 2)
+		{
+			const __m128d arg (_mm_loadu_pd (x + k));
+
+			const __m128d valid (_mm_and_pd (
+				_mm_cmple_pd (zero, arg), _mm_cmple_pd (arg, bound)));
+
+			const __m128d result (kernel (arg));
+
+			_mm_storeu_pd (out + k, _mm_or_pd (
+				_mm_and_pd (valid, result), _mm_andnot_pd (valid, nan)));
+
+			const int mask (_mm_movemask_pd (valid));
+			num_out_of_range += 2 - (mask & 1) - (mask >> 1);
+
+			if (in_range != 0)
+			{
+				in_range [k] = (mask & 1) != 0;
+				in_range [k + 1] = (mask & 2) != 0;
+			}
+		}
+
+		return num_out_of_range + batch (
+			x + k, count - k, out + k, in_range != 0 ? in_range + k : 0,
+			upper, finite, function);
 	}
 
-	//
-	// Check for NaN for inbound arguments (3 overloads)
-	//
+#endif // SEARCH_CPP_SSE2
 
-	bool is_nan (double x, const std::string& name_of_fun)
+	size_t batch_out_of_range (size_t count, double* out, bool* in_range)
 	{
-		return _isnan (x) != 0;
+		std::fill (out, out + count, qnan);
+
+		if (in_range != 0)
+		{
+			std::fill (in_range, in_range + count, false);
+		}
+
+		return count;
 	}
 
-	bool is_nan (double x, double y, const std::string& name_of_fun)
+	template <typename Rows>
+	void grid (
+		size_t num_w, size_t num_r, unsigned num_threads, const Rows& rows)
 	{
-		return _isnan (x) || _isnan (y);
+		const size_t chunk_size (4096);
+		const size_t rows_per_task (
+			std::max (chunk_size/std::max (num_r, size_t (1)), size_t (1)));
+
+		parallel_for (
+			unsigned ((num_w + rows_per_task - 1)/rows_per_task), num_threads,
+			[&] (unsigned task)
+			{
+				const size_t first (task*rows_per_task);
+				rows (first, std::min (first + rows_per_task, num_w));
+			});
 	}
 
-	bool is_nan (double x, double y, double z, const std::string& name_of_fun)
+	chebyshev_table::chebyshev_table (
+		const std::function<double (double)>& function,
+		double lower, double upper, unsigned num_pieces, unsigned degree)
+		: lower (lower), scale (num_pieces/(upper - lower)),
+		  num_pieces (num_pieces), degree (degree),
+		  coefficients (num_pieces*(degree + 1))
 	{
-		return _isnan (x) || _isnan (y) || _isnan (z);
+		const unsigned num_nodes (degree + 1);
+		const double width ((upper - lower)/num_pieces);
+		std::vector<double> values (num_nodes);
+
+		for (unsigned piece = 0; piece < num_pieces; ++piece)
+		{
+			const double center (lower + (piece + 0.5)*width);
+
+			for (unsigned node = 0; node < num_nodes; ++node)
+			{
+				values [node] = function (
+					center + cos (pi*(node + 0.5)/num_nodes)*(width/2.0));
+			}
+
+			for (unsigned k = 0; k < num_nodes; ++k)
+			{
+				double sum (0.0);
+
+				for (unsigned node = 0; node < num_nodes; ++node)
+				{
+					sum += values [node]*cos (pi*k*(node + 0.5)/num_nodes);
+				}
+
+				coefficients [piece*num_nodes + k] =
+					(k == 0 ? 1.0 : 2.0)*sum/num_nodes;
+			}
+		}
 	}
 
-#endif // SEARCH_CPP_THROW_RANGE
+	double
+	chebyshev_table::operator () (double x) const
+	{
+		const double position ((x - lower)*scale);
+		const unsigned piece (std::min (unsigned (position), num_pieces - 1));
+
+		// x mapped to [-1, 1] within the piece, Clenshaw's recurrence
+
+		const double t (2.0*(position - piece) - 1.0);
+		const double* const c (&coefficients [piece*(degree + 1)]);
+		double b1 (0.0), b2 (0.0);
+
+		for (unsigned k = degree; k > 0; --k)
+		{
+			const double b0 (c [k] + 2.0*t*b1 - b2);
+			b2 = b1;
+			b1 = b0;
+		}
+
+		return c [0] + t*b1 - b2;
+	}
 
 } // namespace search
 
@@ -180,21 +673,22 @@ namespace search
 // guaranteed search.
 //
 
-double search::f (double w, double r)
+template <typename Policy>
+double search::f (double w, double r) noexcept (!Policy::throws)
 {
-	static const std::string name_of_fun ("f(double,double)");
+	static const char* const name_of_fun ("f(double,double)");
 
-	if (is_nan (w, r, name_of_fun))
+	if (is_nan (w, r, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
 
-	if (out_of_range (0.0 <= w && w <= 1.0, name_of_fun))
+	if (out_of_range (0.0 <= w && w <= 1.0, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
 
-	if (out_of_range (0.0 <= r, name_of_fun))
+	if (out_of_range (0.0 <= r, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
@@ -202,21 +696,22 @@ double search::f (double w, double r)
 	return 2.0*r*(w*(pi - acos (w)) + sqrt (1.0 - w*w));
 }
 
-double search::g (double w, double r)
+template <typename Policy>
+double search::g (double w, double r) noexcept (!Policy::throws)
 {
-	static const std::string name_of_fun ("g(double,double)");
+	static const char* const name_of_fun ("g(double,double)");
 
-	if (is_nan (w, r, name_of_fun))
+	if (is_nan (w, r, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
 
-	if (out_of_range (0.0 <= w && w <= 1.0, name_of_fun))
+	if (out_of_range (0.0 <= w && w <= 1.0, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
 
-	if (out_of_range (0.0 <= r, name_of_fun))
+	if (out_of_range (0.0 <= r, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
@@ -225,16 +720,17 @@ double search::g (double w, double r)
 	return pi*r*r*tmp*tmp;
 }
 
-double search::h (double w, double r, double a)
+template <typename Policy>
+double search::h (double w, double r, double a) noexcept (!Policy::throws)
 {
-	static const std::string name_of_fun ("h(double,double,double)");
+	static const char* const name_of_fun ("h(double,double,double)");
 
-	if (is_nan (w, r, a, name_of_fun))
+	if (is_nan (w, r, a, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
 
-	if (out_of_range (0.0 <= w && w <= 1.0, name_of_fun))
+	if (out_of_range (0.0 <= w && w <= 1.0, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
@@ -242,39 +738,130 @@ double search::h (double w, double r, double a)
 	// this check may be taken away if needed:
 	// the function will work on any value of r,
 	// provided that r/a doesn't evaluate to infinity
-	if (out_of_range (0.0 <= r && r <= pi*a, name_of_fun))
+	if (out_of_range (0.0 <= r && r <= pi*a, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
 
-	if (out_of_range (0.0 < a, name_of_fun))
+	if (out_of_range (0.0 < a, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
 
+	// r/a is NaN if both r and a are infinite
 	r /= a;
 
-	const double r_abs (fabs (r));
-	const double r_limit (1.0e-10);
-
-	if (w == 1.0 && r_abs <= r_limit)
+	if (is_nan (r, name_of_fun, Policy ()))
 	{
-		// A very special case: w=1 and |r|<<1.
-		// The general algorithm is in trouble when
-		// r^4 evaluates to 0, that is, |r^4| ~ 1e-310.
-		// We'll use
-		//    h(1,r) = 4/sqrt(3) + 2*pi*r + O(r^3)
-		// in the vicinity of r = 0 where this approximation
-		// is accurate enough.
+		return qnan;
+	}
 
-		const double lim (4.0/sqrt (3.0));
+	return h_column (r) (w, a);
+}
 
-		if (r > 0.0)
-		{
-			return a*(lim + 2.0*pi*r);
-		}
-		else
-		if (r == 0.0)
+//
+// Note: h_column holds the values of h (w, r, a) depending
+// on r only, so that they can be shared in a grid.  Its
+// operator () evaluates h (w, a*r, a) as follows.
+//
+
+const double search::h_column::r_limit_1 (1.0e-5);
+const double search::h_column::r_limit_2 (2.0e-5);
+const double search::h_column::r_limit_3 (pi/2.0);
+
+//
+// I used Mathematica 2.2 to get the coefficients
+// of the power series.  The signs of the terms are
+// carried by the numerators and denominators.
+//
+
+const double search::h_column::x_numerators [12] =
+{
+	1.0, -2.0, 1.0, -2.0, 2.0, -4.0,
+	1.0, -2.0, 2.0, -4.0, 2.0, -4.0
+};
+
+const double search::h_column::x_denominators [12] =
+{
+	3.0,
+	45.0,
+	315.0,
+	14175.0,
+	467775.0,
+	42567525.0,
+	638512875.0,
+	97692469875.0,
+	9280784638125.0,
+	2143861251406875.0,
+	147926426347074375.0,
+	48076088562799171875.0
+};
+
+const double search::h_column::yz_denominators [10] =
+{
+	-6.0,
+	120.0,
+	-5040.0,
+	362880.0,
+	-39916800.0,
+	6227020800.0,
+	-1307674368000.0,
+	355687428096000.0,
+	-121645100408832000.0,
+	51090942171709440000.0
+};
+
+search::h_column::h_column (double r)
+	: r (r), r_abs (fabs (r)), r2 (r*r),
+	  c (cos (r)), s (sin (r)), p (), x_series (0.0)
+{
+	if (r_abs <= r_limit_3)
+	{
+		p [0] = r2;
+
+		for (int ind = 1; ind < 12; ++ind)
+		{
+			p [ind] = p [ind - 1]*r2;
+		}
+
+		x_series = p [0]*x_numerators [0]/x_denominators [0];
+
+		for (int ind = 1; ind < 12; ++ind)
+		{
+			x_series += p [ind]*x_numerators [ind]/x_denominators [ind];
+		}
+	}
+}
+
+bool
+search::h_column::regular () const
+{
+	return r_abs > r_limit_2;
+}
+
+double
+search::h_column::operator () (double w, double a) const
+{
+	const double r_limit (1.0e-10);
+
+	if (w == 1.0 && r_abs <= r_limit)
+	{
+		// A very special case: w=1 and |r|<<1.
+		// The general algorithm is in trouble when
+		// r^4 evaluates to 0, that is, |r^4| ~ 1e-310.
+		// We'll use
+		//    h(1,r) = 4/sqrt(3) + 2*pi*r + O(r^3)
+		// in the vicinity of r = 0 where this approximation
+		// is accurate enough.
+
+		const double lim (4.0/sqrt (3.0));
+
+		if (r > 0.0)
+		{
+			return a*(lim + 2.0*pi*r);
+		}
+		else
+		if (r == 0.0)
 		{
 			// For h(1,0) we'll return 0, while, strictly
 			// speaking, h(1,0) is not defined:
@@ -294,9 +881,6 @@ double search::h (double w, double r, double a)
 	// depending on the relation between w and r,
 	// different algorithms will be used
 
-	const double r_limit_1 (1.0e-5);
-	const double r_limit_2 (2.0e-5);
-	const double r_limit_3 (pi/2.0);
 	int wr_case;
 
 	if (r_abs > r_limit_3)
@@ -321,15 +905,12 @@ double search::h (double w, double r, double a)
 	else
 	{
 		// wr_case = 4; can handle this case immediately:
-		return a*f (w, r);
+		return a*f<unchecked> (w, r);
 	}
 
 	// intermediate values
 
 	const double w2 (w*w);
-	const double r2 (r*r);
-	const double c (cos (r));
-	const double s (sin (r));
 	const double ws (w*s);
 	const double ws_r (r==0.0 ? w : ws/r);
 
@@ -347,54 +928,18 @@ double search::h (double w, double r, double a)
 	{
 		// Expand into power series to ensure
 		// uniform accuracy over the range -pi/2 <= r <= pi/2.
-		// I used Mathematica 2.2 to get the coefficients.
 
-		double p[12];	// even powers of r
-		p[0] = r2;
+		x = (1.0 - w)*(1.0 + w) + w2*x_series;
+		y = 1.0 - w;
+		z = 1.0 - w2;
 
-		for (int ind = 1; ind < 12; ++ind)
+		for (int ind = 0; ind < 10; ++ind)
 		{
-			p[ind] = p[ind-1]*r2;
-		}
-
-		x =	(1.0 - w)*(1.0 + w) + w2*(
-			+ p[0]       / 3.0
-			- p[1] * 2.0 / 45.0
-			+ p[2]       / 315.0
-			- p[3] * 2.0 / 14175.0
-			+ p[4] * 2.0 / 467775.0
-			- p[5] * 4.0 / 42567525.0
-			+ p[6]       / 638512875.0
-			- p[7] * 2.0 / 97692469875.0
-			+ p[8] * 2.0 / 9280784638125.0
-			- p[9] * 4.0 / 2143861251406875.0
-			+ p[10]* 2.0 / 147926426347074375.0
-			- p[11]* 4.0 / 48076088562799171875.0
-		);
+			const double odd (2.0*ind + 3.0);
 
-		y = (1.0 - w)
-			- p[0] * (3.0 - w) / 6.0
-			+ p[1] * (5.0 - w) / 120.0
-			- p[2] * (7.0 - w) / 5040.0
-			+ p[3] * (9.0 - w) / 362880.0
-			- p[4] * (11.0 - w)/ 39916800.0
-			+ p[5] * (13.0 - w)/ 6227020800.0
-			- p[6] * (15.0 - w)/ 1307674368000.0
-			+ p[7] * (17.0 - w)/ 355687428096000.0
-			- p[8] * (19.0 - w)/ 121645100408832000.0
-			+ p[9] * (21.0 - w)/ 51090942171709440000.0;
- 
-		z = (1.0 - w2)
-			- p[0] * (3.0 - w2) / 6.0
-			+ p[1] * (5.0 - w2) / 120.0
-			- p[2] * (7.0 - w2) / 5040.0
-			+ p[3] * (9.0 - w2) / 362880.0
-			- p[4] * (11.0 - w2)/ 39916800.0
-			+ p[5] * (13.0 - w2)/ 6227020800.0
-			- p[6] * (15.0 - w2)/ 1307674368000.0
-			+ p[7] * (17.0 - w2)/ 355687428096000.0
-			- p[8] * (19.0 - w2)/ 121645100408832000.0
-			+ p[9] * (21.0 - w2)/ 51090942171709440000.0;
+			y += p [ind]*(odd - w)/yz_denominators [ind];
+			z += p [ind]*(odd - w2)/yz_denominators [ind];
+		}
 	}
 
 	const double h1 (2.0*ws*(pi - acos (ws_r)));
@@ -408,7 +953,7 @@ double search::h (double w, double r, double a)
 	{
 		result = (
 			result * (r_limit_2 - r_abs) +
-			f (w, r)* (r_abs - r_limit_1)
+			f<unchecked> (w, r)* (r_abs - r_limit_1)
 				) /
 			(r_limit_2 - r_limit_1);
 	}
@@ -416,16 +961,91 @@ double search::h (double w, double r, double a)
 	return a*result;
 }
 
-double search::pf_plane (double z)
+#ifdef SEARCH_CPP_SSE2
+
+//
+// The same operations as above in wr_case 1 and 2,
+// so that the results are the same
+//
+
+__m128d
+search::h_column::operator () (__m128d w, double a) const
 {
-	static const std::string name_of_fun ("pf_plane(double)");
+	const __m128d one (_mm_set1_pd (1.0));
+	const __m128d two (_mm_set1_pd (2.0));
+	const __m128d cos_r (_mm_set1_pd (c));
+	const __m128d r2_x (_mm_set1_pd (r2));
 
-	if (is_nan (z, name_of_fun))
+	const __m128d w2 (_mm_mul_pd (w, w));
+	const __m128d ws (_mm_mul_pd (w, _mm_set1_pd (s)));
+	const __m128d ws_r (_mm_div_pd (ws, _mm_set1_pd (r)));
+
+	__m128d x, y, z;
+
+	if (r_abs > r_limit_3)
+	{
+		x = _mm_sub_pd (one, _mm_mul_pd (ws_r, ws_r));
+		y = _mm_sub_pd (cos_r, ws_r);
+		z = _mm_sub_pd (cos_r, _mm_mul_pd (ws_r, w));
+	}
+	else
+	{
+		x = _mm_add_pd (
+			_mm_mul_pd (_mm_sub_pd (one, w), _mm_add_pd (one, w)),
+			_mm_mul_pd (w2, _mm_set1_pd (x_series)));
+		y = _mm_sub_pd (one, w);
+		z = _mm_sub_pd (one, w2);
+
+		for (int ind = 0; ind < 10; ++ind)
+		{
+			const __m128d odd (_mm_set1_pd (2.0*ind + 3.0));
+			const __m128d power (_mm_set1_pd (p [ind]));
+			const __m128d denominator (_mm_set1_pd (yz_denominators [ind]));
+
+			y = _mm_add_pd (y, _mm_div_pd (
+				_mm_mul_pd (power, _mm_sub_pd (odd, w)), denominator));
+			z = _mm_add_pd (z, _mm_div_pd (
+				_mm_mul_pd (power, _mm_sub_pd (odd, w2)), denominator));
+		}
+	}
+
+	// acos has no SSE2 counterpart
+
+	double lanes [2];
+	_mm_storeu_pd (lanes, ws_r);
+	const __m128d arccos (_mm_set_pd (acos (lanes [1]), acos (lanes [0])));
+
+	const __m128d sqrt_x (_mm_sqrt_pd (x));
+	const __m128d r2_x_x (_mm_mul_pd (_mm_mul_pd (r2_x, x), x));
+
+	const __m128d h1 (_mm_mul_pd (
+		_mm_mul_pd (two, ws), _mm_sub_pd (_mm_set1_pd (pi), arccos)));
+	const __m128d h2 (_mm_div_pd (
+		_mm_add_pd (
+			_mm_mul_pd (_mm_mul_pd (two, y), z),
+			_mm_mul_pd (_mm_mul_pd (_mm_set1_pd (2.0*r2), x), x)),
+		_mm_mul_pd (sqrt_x,
+			_mm_sqrt_pd (_mm_add_pd (_mm_mul_pd (z, z), r2_x_x)))));
+	const __m128d h3 (_mm_div_pd (
+		_mm_mul_pd (_mm_mul_pd (_mm_set1_pd (-2.0), y), cos_r), sqrt_x));
+
+	return _mm_mul_pd (_mm_set1_pd (a), _mm_add_pd (
+		h1, _mm_div_pd (_mm_add_pd (h2, h3), _mm_set1_pd (r))));
+}
+
+#endif // SEARCH_CPP_SSE2
+
+template <typename Policy>
+double search::pf_plane (double z) noexcept (!Policy::throws)
+{
+	static const char* const name_of_fun ("pf_plane(double)");
+
+	if (is_nan (z, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
 
-	if (out_of_range (0.0 <= z, name_of_fun))
+	if (out_of_range (0.0 <= z, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
@@ -433,16 +1053,17 @@ double search::pf_plane (double z)
 	return 2.0*sqrt (pi)*sqrt (z);
 }
 
-double search::ipf_plane (double p)
+template <typename Policy>
+double search::ipf_plane (double p) noexcept (!Policy::throws)
 {
-	static const std::string name_of_fun ("ipf_plane(double)");
+	static const char* const name_of_fun ("ipf_plane(double)");
 
-	if (is_nan (p, name_of_fun))
+	if (is_nan (p, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
 
-	if (out_of_range (0.0 <= p, name_of_fun))
+	if (out_of_range (0.0 <= p, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
@@ -450,21 +1071,22 @@ double search::ipf_plane (double p)
 	return (p/(4.0*pi))*p;
 }
 
-double search::pf_angle (double z, double theta)
+template <typename Policy>
+double search::pf_angle (double z, double theta) noexcept (!Policy::throws)
 {
-	static const std::string name_of_fun ("pf_angle(double,double)");
+	static const char* const name_of_fun ("pf_angle(double,double)");
 
-	if (is_nan (z, theta, name_of_fun))
+	if (is_nan (z, theta, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
 
-	if (out_of_range (0.0 <= z, name_of_fun))
+	if (out_of_range (0.0 <= z, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
 	
-	if (out_of_range (0.0 < theta && theta < 2.0*pi, name_of_fun))
+	if (out_of_range (0.0 < theta && theta < 2.0*pi, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
@@ -472,21 +1094,22 @@ double search::pf_angle (double z, double theta)
 	return sqrt (2.0*std::min (theta, pi))*sqrt (z);
 }
 
-double search::ipf_angle (double p, double theta)
+template <typename Policy>
+double search::ipf_angle (double p, double theta) noexcept (!Policy::throws)
 {
-	static const std::string name_of_fun ("ipf_angle(double,double)");
+	static const char* const name_of_fun ("ipf_angle(double,double)");
 
-	if (is_nan (p, theta, name_of_fun))
+	if (is_nan (p, theta, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
 
-	if (out_of_range (0.0 <= p, name_of_fun))
+	if (out_of_range (0.0 <= p, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
 
-	if (out_of_range (0.0 < theta && theta < 2.0*pi, name_of_fun))
+	if (out_of_range (0.0 < theta && theta < 2.0*pi, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
@@ -494,21 +1117,22 @@ double search::ipf_angle (double p, double theta)
 	return p/(2.0*std::min (theta, pi))*p;
 }
 
-double search::pf_sphere (double z, double a)
+template <typename Policy>
+double search::pf_sphere (double z, double a) noexcept (!Policy::throws)
 {
-	static const std::string name_of_fun ("pf_sphere(double,double)");
+	static const char* const name_of_fun ("pf_sphere(double,double)");
 
-	if (is_nan (z, a, name_of_fun))
+	if (is_nan (z, a, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
 
-	if (out_of_range (0.0 <= z && z <= 4.0*pi*a*a && z < pos_infinity, name_of_fun))
+	if (out_of_range (0.0 <= z && z <= 4.0*pi*a*a && z < pos_infinity, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
 
-	if (out_of_range (0.0 < a, name_of_fun))
+	if (out_of_range (0.0 < a, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
@@ -516,21 +1140,22 @@ double search::pf_sphere (double z, double a)
 	return 2.0*sqrt (z)*sqrt (pi - z/(4.0*a*a));
 }
 
-double search::ipf_sphere (double p, double a)
+template <typename Policy>
+double search::ipf_sphere (double p, double a) noexcept (!Policy::throws)
 {
-	static const std::string name_of_fun ("ipf_sphere(double,double)");
+	static const char* const name_of_fun ("ipf_sphere(double,double)");
 
-	if (is_nan (p, a, name_of_fun))
+	if (is_nan (p, a, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
 
-	if (out_of_range (0.0 <= p && p <= 2.0*pi*a && p < pos_infinity, name_of_fun))
+	if (out_of_range (0.0 <= p && p <= 2.0*pi*a && p < pos_infinity, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
 
-	if (out_of_range (0.0 < a, name_of_fun))
+	if (out_of_range (0.0 < a, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
@@ -589,21 +1214,22 @@ double search::aux_1 (double beta)
 // In some cases, the substitute beta = alpha - pi/2 is used.
 //
 
-double search::pf_circle (double z, double a)
+template <typename Policy>
+double search::pf_circle (double z, double a) noexcept (!Policy::throws)
 {
-	static const std::string name_of_fun ("pf_circle(double,double)");
+	static const char* const name_of_fun ("pf_circle(double,double)");
 
-	if (is_nan (z, a, name_of_fun))
+	if (is_nan (z, a, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
 
-	if (out_of_range (0.0 <= z && z <= pi*a*a && z < pos_infinity, name_of_fun))
+	if (out_of_range (0.0 <= z && z <= pi*a*a && z < pos_infinity, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
 
-	if (out_of_range (0.0 <= a, name_of_fun))
+	if (out_of_range (0.0 <= a, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
@@ -628,82 +1254,49 @@ double search::pf_circle (double z, double a)
 		z = pi - z;
 	}
 
-	if (z == 0.0)
+	if (z <= 0.0)
 	{
 		return 0.0;
 	}
 
-	double beta_left (0.0);
-	double beta_right (pi/2.0);
+	// the derivative of (2) with respect to beta
+	auto derivative_2 = [] (double beta, double t)
+	{
+		return (pi - 2.0*beta)*t*(1.0 + t*t) - 2.0*t*t;
+	};
+
 	double beta;
-	double beta_left_old;
-	double beta_right_old;
 	double result;
 
 	if (z < pi/2.0 - 1.0)
 	{
-		for (;;)
-		{
-			beta = (beta_left + beta_right)/2.0;
-			beta_left_old = beta_left;
-			beta_right_old = beta_right;
+		// z ~ pi/2*beta^2 for small beta
 
-			if (aux_1 (beta) > z)
-			{
-				beta_right = beta;
-
-				if (beta_right >= beta_right_old)
-				{
-					break;
-				}
-			}
-			else
+		beta = newton (
+			[&] (double beta, double& derivative)
 			{
-				beta_left = beta;
-
-				if (beta_left <= beta_left_old)
-				{
-					break;
-				}
-			}
-		}
+				derivative = derivative_2 (beta, tan (beta));
+				return aux_1 (beta) - z;
+			},
+			0.0, pi/2.0, sqrt (2.0*z/pi), true);
 
 		result = (pi - 2.0*beta)*sin (beta)/cos (beta);
 	}
 	else
 	{
-		for (;;)
-		{
-			beta = (beta_left + beta_right)/2.0;
-			beta_left_old = beta_left;
-			beta_right_old = beta_right;
-
-			if (beta == pi/2.0)
-			{
-				break;
-			}
+		// z ~ pi/2 - 4/3*(pi/2 - beta) for beta close to pi/2;
+		// tan(beta) is taken as cot(e), e = pi/2 - beta, to agree
+		// with the factor pi/2 - beta (see ipf_circle)
 
-			const double t (sin (beta)/cos (beta));
-
-			if (beta - t + t*(pi/2.0 - beta)*t > z)
-			{
-				beta_right = beta;
-
-				if (beta_right >= beta_right_old)
-				{
-					break;
-				}
-			}
-			else
+		beta = newton (
+			[&] (double beta, double& derivative)
 			{
-				beta_left = beta;
-
-				if (beta_left <= beta_left_old)
-				{
-					break;
-				}
-			}
-		}
+				const double e (pi/2.0 - beta);
+				const double t (cos (e)/sin (e));
+				derivative = derivative_2 (beta, t);
+				return beta - t + t*e*t - z;
+			},
+			0.0, pi/2.0, pi/2.0 - 0.75*(pi/2.0 - z), true);
 
 		const double c (sin (pi/2.0 - beta));
 
@@ -720,21 +1313,22 @@ double search::pf_circle (double z, double a)
 	return a*result;
 }
 
-double search::ipf_circle (double p, double a)
+template <typename Policy>
+double search::ipf_circle (double p, double a) noexcept (!Policy::throws)
 {
-	static const std::string name_of_fun ("ipf_circle(double,double)");
+	static const char* const name_of_fun ("ipf_circle(double,double)");
 
-	if (is_nan (p, a, name_of_fun))
+	if (is_nan (p, a, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
 
-	if (out_of_range (0.0 <= p && p <= 2.0*a && p < pos_infinity, name_of_fun))
+	if (out_of_range (0.0 <= p && p <= 2.0*a && p < pos_infinity, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
 
-	if (out_of_range (0.0 <= a, name_of_fun))
+	if (out_of_range (0.0 <= a, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
@@ -753,43 +1347,38 @@ double search::ipf_circle (double p, double a)
 
 	p = p_norm;
 
-	double beta_left (0.0);
-	double beta_right (pi/2.0);
-	double beta;
-	double beta_left_old;
-	double beta_right_old;
-	double result;
-
-	for (;;)
+	if (p >= 2.0)
 	{
-		beta = (beta_left + beta_right)/2.0;
-		beta_left_old = beta_left;
-		beta_right_old = beta_right;
+		return a*(pi/2.0)*a;
+	}
 
-		if (beta == pi/2.0)
-		{
-			break;
-		}
+	double result;
 
-		if ((pi - 2.0*beta)*sin (beta)/cos (beta) > p)
-		{
-			beta_right = beta;
+	// p ~ pi*beta for small beta,
+	// p ~ 2 - 2/3*(pi/2 - beta)^2 for beta close to pi/2.
+	// Above pi/4, tan(beta) is taken as cot(e), e = pi/2 - beta,
+	// so that it agrees with the factor pi - 2*beta = 2*e, which
+	// is what keeps the root meaningful for p close to 2.
 
-			if (beta_right >= beta_right_old)
+	const double beta (newton (
+		[&] (double beta, double& derivative)
+		{
+			if (beta < pi/4.0)
 			{
-				break;
+				const double t (sin (beta)/cos (beta));
+				derivative = (pi - 2.0*beta)*(1.0 + t*t) - 2.0*t;
+				return (pi - 2.0*beta)*t - p;
 			}
-		}
-		else
-		{
-			beta_left = beta;
-
-			if (beta_left <= beta_left_old)
+			else
 			{
-				break;
+				const double e (pi/2.0 - beta);
+				const double t (cos (e)/sin (e));
+				derivative = 2.0*(e*(1.0 + t*t) - t);
+				return 2.0*e*t - p;
 			}
-		}
-	}
+		},
+		0.0, pi/2.0,
+		p < 1.0 ? p/pi : pi/2.0 - sqrt (1.5*(2.0 - p)), true));
 
 	if (beta < pi/4.0)
 	{
@@ -803,34 +1392,36 @@ double search::ipf_circle (double p, double a)
 		}
 		else
 		{
-			const double t (sin (beta)/cos (beta));
-			result = beta - t + t*(pi/2.0 - beta)*t;
+			const double e (pi/2.0 - beta);
+			const double t (cos (e)/sin (e));
+			result = beta - t + t*e*t;
 		}
 	}
 
 	return a*result*a;
 }
 
-double search::opf_circle (double z, double a)
+template <typename Policy>
+double search::opf_circle (double z, double a) noexcept (!Policy::throws)
 {
-	static const std::string name_of_fun ("opf_circle(double,double)");
+	static const char* const name_of_fun ("opf_circle(double,double)");
 
-	if (is_nan (z, a, name_of_fun))
+	if (is_nan (z, a, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
 
-	if (out_of_range (z < pos_infinity || a < pos_infinity, name_of_fun))
+	if (out_of_range (z < pos_infinity || a < pos_infinity, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
 
-	if (out_of_range (0.0 <= z, name_of_fun))
+	if (out_of_range (0.0 <= z, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
 
-	if (out_of_range (0.0 <= a, name_of_fun))
+	if (out_of_range (0.0 <= a, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
@@ -864,82 +1455,32 @@ double search::opf_circle (double z, double a)
 
 	if (z < pi/2.0 - 1.0)
 	{
-		double beta_left (-pi/2.0);
-		double beta_right (0.0);
-		double beta;
-		double beta_left_old;
-		double beta_right_old;
-
-		for (;;)
-		{
-			beta = (beta_left + beta_right)/2.0;
-			beta_left_old = beta_left;
-			beta_right_old = beta_right;
-
-			if (aux_1 (beta) < z)
-			{
-				beta_right = beta;
+		// z ~ pi/2*beta^2 for small beta
 
-				if (beta_right >= beta_right_old)
-				{
-					break;
-				}
-			}
-			else
+		const double beta (newton (
+			[&] (double beta, double& derivative)
 			{
-				beta_left = beta;
-
-				if (beta_left <= beta_left_old)
-				{
-					break;
-				}
-			}
-		}
+				const double t (tan (beta));
+				derivative = (pi - 2.0*beta)*t*(1.0 + t*t) - 2.0*t*t;
+				return aux_1 (beta) - z;
+			},
+			-pi/2.0, 0.0, -sqrt (2.0*z/pi), false));
 
 		result = (2.0*beta - pi)*sin (beta)/cos (beta);
 	}
 	else
 	{
-		double alpha_left (0.0);
-		double alpha_right (pi/2.0);
-		double alpha;
-		double alpha_left_old;
-		double alpha_right_old;
-
-		for (;;)
-		{
-			alpha = (alpha_left + alpha_right)/2.0;
-			alpha_left_old = alpha_left;
-			alpha_right_old = alpha_right;
-
-			const double t (sin (alpha)/cos (alpha));
-			const double tt (t*t);
-
-			if (tt == 0.0)
-			{
-				alpha = 0.0;
-				break;
-			}
-
-			if (-pi/2.0 + alpha + 1/t + (pi - alpha)/(t*t) < z)
-			{
-				alpha_right = alpha;
+		// z ~ pi*cot^2(alpha) for small alpha
 
-				if (alpha_right >= alpha_right_old)
-				{
-					break;
-				}
-			}
-			else
+		const double alpha (newton (
+			[&] (double alpha, double& derivative)
 			{
-				alpha_left = alpha;
-
-				if (alpha_left <= alpha_left_old)
-				{
-					break;
-				}
-			}
-		}
+				const double t (sin (alpha)/cos (alpha));
+				const double u (1.0/t);
+				derivative = -2.0*u*u - 2.0*(pi - alpha)*u*(1.0 + u*u);
+				return -pi/2.0 + alpha + 1/t + (pi - alpha)/(t*t) - z;
+			},
+			0.0, pi/2.0, atan (sqrt (pi/z)), false));
 
 		result = 2.0*(pi - alpha)*cos (alpha)/sin (alpha);
 	}
@@ -947,26 +1488,27 @@ double search::opf_circle (double z, double a)
 	return a*result;
 }
 
-double search::iopf_circle (double p, double a)
+template <typename Policy>
+double search::iopf_circle (double p, double a) noexcept (!Policy::throws)
 {
-	static const std::string name_of_fun ("iopf_circle(double,double)");
+	static const char* const name_of_fun ("iopf_circle(double,double)");
 
-	if (is_nan (p, a, name_of_fun))
+	if (is_nan (p, a, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
 
-	if (out_of_range (p < pos_infinity || a < pos_infinity, name_of_fun))
+	if (out_of_range (p < pos_infinity || a < pos_infinity, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
 
-	if (out_of_range (0.0 <= p, name_of_fun))
+	if (out_of_range (0.0 <= p, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
 
-	if (out_of_range (0.0 <= a, name_of_fun))
+	if (out_of_range (0.0 <= a, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
@@ -1000,81 +1542,32 @@ double search::iopf_circle (double p, double a)
 
 	if (p < pi/2.0)
 	{
-		double beta_left (-pi/2.0);
-		double beta_right (0.0);
-		double beta;
-		double beta_left_old;
-		double beta_right_old;
-
-		for (;;)
-		{
-			beta = (beta_left + beta_right)/2.0;
-			beta_left_old = beta_left;
-			beta_right_old = beta_right;
+		// p ~ -pi*beta for small beta
 
-			if ((2*beta - pi)*sin (beta)/cos (beta) < p)
+		const double beta (newton (
+			[&] (double beta, double& derivative)
 			{
-				beta_right = beta;
-
-				if (beta_right >= beta_right_old)
-				{
-					break;
-				}
-			}
-			else
-			{
-				beta_left = beta;
-
-				if (beta_left <= beta_left_old)
-				{
-					break;
-				}
-			}
-		}
+				const double t (sin (beta)/cos (beta));
+				derivative = (2.0*beta - pi)*(1.0 + t*t) + 2.0*t;
+				return (2*beta - pi)*t - p;
+			},
+			-pi/2.0, 0.0, -p/pi, false));
 
 		result = aux_1 (beta);
 	}
 	else
 	{
-		double alpha_left (0.0);
-		double alpha_right (pi/2.0);
-		double alpha;
-		double alpha_left_old;
-		double alpha_right_old;
-
-		for (;;)
-		{
-			alpha = (alpha_left + alpha_right)/2.0;
-			alpha_left_old = alpha_left;
-			alpha_right_old = alpha_right;
-
-			const double t (sin (alpha)/cos (alpha));
-
-			if (t == 0.0)
-			{
-				alpha = 0.0;
-				break;
-			}
-
-			if (2.0*(pi - alpha)/t < p)
-			{
-				alpha_right = alpha;
+		// p ~ 2*pi*cot(alpha) for small alpha
 
-				if (alpha_right >= alpha_right_old)
-				{
-					break;
-				}
-			}
-			else
+		const double alpha (newton (
+			[&] (double alpha, double& derivative)
 			{
-				alpha_left = alpha;
-
-				if (alpha_left <= alpha_left_old)
-				{
-					break;
-				}
-			}
-		}
+				const double t (sin (alpha)/cos (alpha));
+				const double u (1.0/t);
+				derivative = -2.0*u - 2.0*(pi - alpha)*(1.0 + u*u);
+				return 2.0*(pi - alpha)/t - p;
+			},
+			0.0, pi/2.0, atan (2.0*pi/p), false));
 
 		const double t (sin (alpha)/cos (alpha));
 		result = -pi/2.0 + alpha + 1.0/t + (pi - alpha)/(t*t);
@@ -1083,26 +1576,27 @@ double search::iopf_circle (double p, double a)
 	return a*result*a;
 }
 
-double search::pf_rectangle (double z, double a, double b)
+template <typename Policy>
+double search::pf_rectangle (double z, double a, double b) noexcept (!Policy::throws)
 {
-	static const std::string name_of_fun ("pf_rectangle(double,double,double)");
+	static const char* const name_of_fun ("pf_rectangle(double,double,double)");
 
-	if (is_nan (z, a, b, name_of_fun))
+	if (is_nan (z, a, b, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
 
-	if (out_of_range (0.0 <= a && a < pos_infinity, name_of_fun))
+	if (out_of_range (0.0 <= a && a < pos_infinity, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
 
-	if (out_of_range (0.0 <= b && b < pos_infinity, name_of_fun))
+	if (out_of_range (0.0 <= b && b < pos_infinity, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
 
-	if (out_of_range (0.0 <= z && z <= a*b && z < pos_infinity, name_of_fun))
+	if (out_of_range (0.0 <= z && z <= a*b && z < pos_infinity, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
@@ -1130,21 +1624,22 @@ double search::pf_rectangle (double z, double a, double b)
 	}
 }
 
-double search::ipf_rectangle (double p, double a, double b)
+template <typename Policy>
+double search::ipf_rectangle (double p, double a, double b) noexcept (!Policy::throws)
 {
-	static const std::string name_of_fun ("ipf_rectangle(double,double,double)");
+	static const char* const name_of_fun ("ipf_rectangle(double,double,double)");
 
-	if (is_nan (p, a, b, name_of_fun))
+	if (is_nan (p, a, b, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
 
-	if (out_of_range (0.0 <= a && a < pos_infinity, name_of_fun))
+	if (out_of_range (0.0 <= a && a < pos_infinity, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
 
-	if (out_of_range (0.0 <= b && b < pos_infinity, name_of_fun))
+	if (out_of_range (0.0 <= b && b < pos_infinity, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
@@ -1154,7 +1649,7 @@ double search::ipf_rectangle (double p, double a, double b)
 		std::swap (a, b);
 	}
 
-	if (out_of_range (0.0 <= p && p <= a, name_of_fun))
+	if (out_of_range (0.0 <= p && p <= a, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
@@ -1178,26 +1673,27 @@ double search::ipf_rectangle (double p, double a, double b)
 // In iopf_rectangle, p is known and z is sought.
 //
 
-double search::opf_rectangle (double z, double a, double b)
+template <typename Policy>
+double search::opf_rectangle (double z, double a, double b) noexcept (!Policy::throws)
 {
-	static const std::string name_of_fun ("opf_rectangle(double,double,double)");
+	static const char* const name_of_fun ("opf_rectangle(double,double,double)");
 
-	if (is_nan (z, a, b, name_of_fun))
+	if (is_nan (z, a, b, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
 
-	if (out_of_range (0.0 <= a && a < pos_infinity, name_of_fun))
+	if (out_of_range (0.0 <= a && a < pos_infinity, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
 
-	if (out_of_range (0.0 <= b && b < pos_infinity, name_of_fun))
+	if (out_of_range (0.0 <= b && b < pos_infinity, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
 
-	if (out_of_range (0.0 <= z, name_of_fun))
+	if (out_of_range (0.0 <= z, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
@@ -1226,39 +1722,27 @@ double search::opf_rectangle (double z, double a, double b)
 		{
 			double result1, result2;
 
-			double beta_left (0.0);
-			double beta_right (search::pi);
-			double beta;
-			double beta_left_old;
-			double beta_right_old;
-			double r;
+			// the area bounded by the arc of angle 2*pi - beta
+			// over the chord and by the chord, less offset;
+			// z ~ pi*(chord/beta)^2 for small beta
 
-			for (;;)
+			auto solve = [z] (double chord, double offset)
 			{
-				beta = (beta_left + beta_right)/2.0;
-				beta_left_old = beta_left;
-				beta_right_old = beta_right;
-				r = b/(2.0*sin (beta/2.0));
-
-				if (r*(2.0*pi - beta + sin (beta))*(r/2.0) < z)
-				{
-					beta_right = beta;
-
-					if (beta_right >= beta_right_old)
-					{
-						break;
-					}
-				}
-				else
-				{
-					beta_left = beta;
-
-					if (beta_left <= beta_left_old)
+				return newton (
+					[=] (double beta, double& derivative)
 					{
-						break;
-					}
-				}
-			}
+						const double s (sin (beta/2.0));
+						const double n (2.0*pi - beta + sin (beta));
+						const double r (chord/(2.0*s));
+						derivative =
+							-r*(s*s + n*cos (beta/2.0)/(2.0*s))*r;
+						return r*n*(r/2.0) - offset - z;
+					},
+					0.0, pi, chord*sqrt (pi/(z + offset)), false);
+			};
+
+			double beta (solve (b, 0.0));
+			double r (b/(2.0*sin (beta/2.0)));
 
 			result1 = (2.0*pi - beta)*r;
 
@@ -1286,35 +1770,8 @@ double search::opf_rectangle (double z, double a, double b)
 				}
 			}
 
-			beta_left = 0.0;
-			beta_right = pi;
-
-			for (;;)
-			{
-				beta = (beta_left + beta_right)/2.0;
-				beta_left_old = beta_left;
-				beta_right_old = beta_right;
-				r = diag/(2.0*sin (beta/2.0));
-
-				if (r*(2.0*pi - beta + sin (beta))*(r/2.0) - (a/2.0)*b < z)
-				{
-					beta_right = beta;
-
-					if (beta_right >= beta_right_old)
-					{
-						break;
-					}
-				}
-				else
-				{
-					beta_left = beta;
-
-					if (beta_left <= beta_left_old)
-					{
-						break;
-					}
-				}
-			}
+			beta = solve (diag, (a/2.0)*b);
+			r = diag/(2.0*sin (beta/2.0));
 
 			result2 = (2.0*pi - beta)*r;
 
@@ -1323,26 +1780,27 @@ double search::opf_rectangle (double z, double a, double b)
 	}
 }
 
-double search::iopf_rectangle (double p, double a, double b)
+template <typename Policy>
+double search::iopf_rectangle (double p, double a, double b) noexcept (!Policy::throws)
 {
-	static const std::string name_of_fun ("iopf_rectangle(double,double,double)");
+	static const char* const name_of_fun ("iopf_rectangle(double,double,double)");
 
-	if (is_nan (p, a, b, name_of_fun))
+	if (is_nan (p, a, b, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
 
-	if (out_of_range (0.0 <= a && a < pos_infinity, name_of_fun))
+	if (out_of_range (0.0 <= a && a < pos_infinity, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
 
-	if (out_of_range (0.0 <= b && b < pos_infinity, name_of_fun))
+	if (out_of_range (0.0 <= b && b < pos_infinity, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
 
-	if (out_of_range (0.0 <= p, name_of_fun))
+	if (out_of_range (0.0 <= p, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
@@ -1371,39 +1829,25 @@ double search::iopf_rectangle (double p, double a, double b)
 		{
 			double result1, result2;
 
-			double beta_left (0.0);
-			double beta_right (search::pi);
-			double beta;
-			double beta_left_old;
-			double beta_right_old;
-			double r;
+			// the length of the arc of angle 2*pi - beta
+			// over the chord; p ~ 2*pi*chord/beta for small beta
 
-			for (;;)
+			auto solve = [p] (double chord)
 			{
-				beta = (beta_left + beta_right)/2.0;
-				beta_left_old = beta_left;
-				beta_right_old = beta_right;
-				r = b/(2.0*sin (beta/2.0));
-
-				if ((2.0*pi - beta)*r < p)
-				{
-					beta_right = beta;
-
-					if (beta_right >= beta_right_old)
-					{
-						break;
-					}
-				}
-				else
-				{
-					beta_left = beta;
-
-					if (beta_left <= beta_left_old)
+				return newton (
+					[=] (double beta, double& derivative)
 					{
-						break;
-					}
-				}
-			}
+						const double s (sin (beta/2.0));
+						const double r (chord/(2.0*s));
+						derivative = -r -
+							(2.0*pi - beta)*r*cos (beta/2.0)/(2.0*s);
+						return (2.0*pi - beta)*r - p;
+					},
+					0.0, pi, 2.0*pi*(chord/p), false);
+			};
+
+			double beta (solve (b));
+			double r (b/(2.0*sin (beta/2.0)));
 
 			result1 = r*(2.0*pi - beta + sin (beta))*(r/2.0);
 
@@ -1436,53 +1880,27 @@ double search::iopf_rectangle (double p, double a, double b)
 				return result1;
 			}
 
-			beta_left = 0.0;
-			beta_right = pi;
+			beta = solve (diag);
+			r = diag/(2.0*sin (beta/2.0));
 
-			for (;;)
-			{
-				beta = (beta_left + beta_right)/2.0;
-				beta_left_old = beta_left;
-				beta_right_old = beta_right;
-				r = diag/(2.0*sin (beta/2.0));
+			result2 = r*(2.0*pi - beta + sin (beta))*(r/2.0) - (a/2.0)*b;
 
-				if ((2.0*pi - beta)*r < p)
-				{
-					beta_right = beta;
+			return std::max (result1, result2);
+		}
+	}
+}
 
-					if (beta_right >= beta_right_old)
-					{
-						break;
-					}
-				}
-				else
-				{
-					beta_left = beta;
-
-					if (beta_left <= beta_left_old)
-					{
-						break;
-					}
-				}
-			}
-
-			result2 = r*(2.0*pi - beta + sin (beta))*(r/2.0) - (a/2.0)*b;
-
-			return std::max (result1, result2);
-		}
-	}
-}
-
-double search::pf_3d (double z)
+template <typename Policy>
+double search::pf_3d (double z) noexcept (!Policy::throws)
 {
-	static const std::string name_of_fun ("pf_3d(double)");
+	static const char* const name_of_fun ("pf_3d(double)");
 
-	if (is_nan (z, name_of_fun))
+	if (is_nan (z, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
 
-	if (out_of_range (0.0 <= z, name_of_fun))
+	if (out_of_range (0.0 <= z, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
@@ -1490,16 +1908,17 @@ double search::pf_3d (double z)
 	return pow (6.0*sqrt (pi)*z, 2.0/3.0);
 }
 
-double search::ipf_3d (double p)
+template <typename Policy>
+double search::ipf_3d (double p) noexcept (!Policy::throws)
 {
-	static const std::string name_of_fun ("ipf_3d(double)");
+	static const char* const name_of_fun ("ipf_3d(double)");
 
-	if (is_nan (p, name_of_fun))
+	if (is_nan (p, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
 
-	if (out_of_range (0.0 <= p, name_of_fun))
+	if (out_of_range (0.0 <= p, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
@@ -1534,21 +1953,22 @@ double search::aux_2 (double beta)
 	return result;
 }
 
-double search::pf_sphere_3d (double z, double a)
+template <typename Policy>
+double search::pf_sphere_3d (double z, double a) noexcept (!Policy::throws)
 {
-	static const std::string name_of_fun ("pf_sphere_3d(double,double)");
+	static const char* const name_of_fun ("pf_sphere_3d(double,double)");
 
-	if (is_nan (z, a, name_of_fun))
+	if (is_nan (z, a, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
 
-	if (out_of_range (0.0 <= z && z <= (4.0*pi/3.0)*a*a*a && z < pos_infinity, name_of_fun))
+	if (out_of_range (0.0 <= z && z <= (4.0*pi/3.0)*a*a*a && z < pos_infinity, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
 
-	if (out_of_range (0.0 <= a, name_of_fun))
+	if (out_of_range (0.0 <= a, name_of_fun, Policy ()))
 	{
 		return qnan;
 	}
@@ -1574,64 +1994,45 @@ double search::pf_sphere_3d (double z, double a)
 		z = 4.0*pi/3.0 - z;
 	}
 
-	if (z == 0.0)
+	if (z <= 0.0)
 	{
 		return 0.0;
 	}
 
-	double beta_left (0.0);
-	double beta_right (pi/2.0);
 	double beta;
-	double beta_left_old;
-	double beta_right_old;
 	double result;
 
 	if (z < pi/2.0 - 1.0)
 	{
-		for (;;)
-		{
-			beta = (beta_left + beta_right)/2.0;
-			beta_left_old = beta_left;
-			beta_right_old = beta_right;
-
-			double z_beta;
-			const double s (sin (beta));
-
-			if (s == 0.0)
-			{
-				z_beta = 2.0;
-			}
-			else
-			{
-				const double tmp (aux_2 (beta));
-				const double c (1.0 - tmp);
-				const double ct (c/s);
+		// z ~ 2*pi/3*(pi/2 - beta)^3 for beta close to pi/2
 
-				z_beta = (1.0 - s)*(1.0 - s)*(2.0 + s) +
-					tmp*tmp*(2.0 + c)*ct*ct*ct;
-			}
-
-			z_beta *= pi/3.0;
-
-			if (z_beta < z)
+		beta = newton (
+			[&] (double beta, double& derivative)
 			{
-				beta_right = beta;
+				double z_beta;
+				const double s (sin (beta));
 
-				if (beta_right >= beta_right_old)
+				if (s == 0.0)
 				{
-					break;
+					z_beta = 2.0;
+					derivative = 0.0;
 				}
-			}
-			else
-			{
-				beta_left = beta;
-
-				if (beta_left <= beta_left_old)
+				else
 				{
-					break;
+					const double tmp (aux_2 (beta));
+					const double c (1.0 - tmp);
+					const double ct (c/s);
+
+					z_beta = (1.0 - s)*(1.0 - s)*(2.0 + s) +
+						tmp*tmp*(2.0 + c)*ct*ct*ct;
+					derivative = -pi*tmp*tmp*(2.0 + c)*(ct/s)*(ct/s);
 				}
-			}
-		}
+
+				z_beta *= pi/3.0;
+
+				return z_beta - z;
+			},
+			0.0, pi/2.0, pi/2.0 - cbrt (3.0*z/(2.0*pi)), false);
 
 		const double s (sin (beta));
 
@@ -1651,41 +2052,21 @@ double search::pf_sphere_3d (double z, double a)
 	}
 	else
 	{
-		for (;;)
-		{
-			beta = (beta_left + beta_right)/2.0;
-			beta_left_old = beta_left;
-			beta_right_old = beta_right;
-
-			double z_beta;
-			double s (sin (beta));
+		// z ~ 2*pi/3*beta^3 for small beta
 
-			const double tmp (aux_2 (beta));
-			const double c (1.0 - tmp);
-			const double t (s/c);
-
-			z_beta = pi*(tmp*tmp*(2.0 + c) +
-				(1.0 - s)*(1.0 - s)*(2.0 + s)*t*t*t)/3.0;
-
-			if (z_beta > z)
-			{
-				beta_right = beta;
-
-				if (beta_right >= beta_right_old)
-				{
-					break;
-				}
-			}
-			else
+		beta = newton (
+			[&] (double beta, double& derivative)
 			{
-				beta_left = beta;
+				const double s (sin (beta));
+				const double tmp (aux_2 (beta));
+				const double c (1.0 - tmp);
+				const double t (s/c);
+				const double u (1.0 - s);
 
-				if (beta_left <= beta_left_old)
-				{
-					break;
-				}
-			}
-		}
+				derivative = pi*u*u*(2.0 + s)*(t/c)*(t/c);
+				return pi*(tmp*tmp*(2.0 + c) + u*u*(2.0 + s)*t*t*t)/3.0 - z;
+			},
+			0.0, pi/2.0, cbrt (3.0*z/(2.0*pi)), true);
 
 		const double t (tan (beta));
 
@@ -1695,674 +2076,3283 @@ double search::pf_sphere_3d (double z, double a)
 	return a*result*a;
 }
 
-double
-search::convex_polygon::area () const
-{
-	if (num_vertices () < 3)
-	{
-		return 0.0;
-	}
+//
+// Explicit instantiations of the functions above for the
+// checking policies, and their versions without a policy
+//
 
-	double area (0.0);
-	std::list<vertex>::const_iterator iter (vertices.begin ());
-	point origin (iter->coord);
-	++iter;
-	point last (iter->coord);
-	++iter;
+#define SEARCH_CPP_INSTANTIATE(Policy) \
+	template double search::f<search::Policy> (double, double); \
+	template double search::g<search::Policy> (double, double); \
+	template double search::h<search::Policy> (double, double, double); \
+	template double search::pf_plane<search::Policy> (double); \
+	template double search::ipf_plane<search::Policy> (double); \
+	template double search::pf_angle<search::Policy> (double, double); \
+	template double search::ipf_angle<search::Policy> (double, double); \
+	template double search::pf_sphere<search::Policy> (double, double); \
+	template double search::ipf_sphere<search::Policy> (double, double); \
+	template double search::pf_circle<search::Policy> (double, double); \
+	template double search::ipf_circle<search::Policy> (double, double); \
+	template double search::opf_circle<search::Policy> (double, double); \
+	template double search::iopf_circle<search::Policy> (double, double); \
+	template double search::pf_rectangle<search::Policy> (double, double, double); \
+	template double search::ipf_rectangle<search::Policy> (double, double, double); \
+	template double search::opf_rectangle<search::Policy> (double, double, double); \
+	template double search::iopf_rectangle<search::Policy> (double, double, double); \
+	template double search::pf_3d<search::Policy> (double); \
+	template double search::ipf_3d<search::Policy> (double); \
+	template double search::pf_sphere_3d<search::Policy> (double, double);
+
+SEARCH_CPP_INSTANTIATE (throw_on_error)
+SEARCH_CPP_INSTANTIATE (nan_on_error)
+SEARCH_CPP_INSTANTIATE (unchecked)
+
+#undef SEARCH_CPP_INSTANTIATE
 
-	for (; iter != vertices.end (); ++iter)
-	{
-		area += origin.area (last, iter->coord);
-		last = iter->coord;
-	}
+double search::f (double w, double r)
+{
+	return f<throw_on_error> (w, r);
+}
 
-	return area;
+double search::g (double w, double r)
+{
+	return g<throw_on_error> (w, r);
 }
 
-void
-search::convex_polygon::convex_hull ()
+double search::h (double w, double r, double a)
 {
-	if (num_vertices () < 3) return; // nothing to do
+	return h<throw_on_error> (w, r, a);
+}
 
-	// in the case num_vertices = 3 nothing to do either,
-	// but the resulting order of vertices is important
+double search::pf_plane (double z)
+{
+	return pf_plane<throw_on_error> (z);
+}
 
-	std::list<vertex> hull; // will hold the convex hull
+double search::ipf_plane (double p)
+{
+	return ipf_plane<throw_on_error> (p);
+}
 
-	// find the lower right point
+double search::pf_angle (double z, double theta)
+{
+	return pf_angle<throw_on_error> (z, theta);
+}
 
-	std::list<vertex>::iterator iter (vertices.begin ()), select (iter);
+double search::ipf_angle (double p, double theta)
+{
+	return ipf_angle<throw_on_error> (p, theta);
+}
 
-	point lr_point (iter->coord); // lower right point
-	++iter;
+double search::pf_sphere (double z, double a)
+{
+	return pf_sphere<throw_on_error> (z, a);
+}
 
-	for (; iter != vertices.end (); ++iter)
-	{
-		point cur (iter->coord);
+double search::ipf_sphere (double p, double a)
+{
+	return ipf_sphere<throw_on_error> (p, a);
+}
 
-		if (cur.y < lr_point.y || (cur.y == lr_point.y && cur.x > lr_point.x))
-		{
-			lr_point = cur;
-			select = iter;
-		}
-	}
+double search::pf_circle (double z, double a)
+{
+	return pf_circle<throw_on_error> (z, a);
+}
 
-	// mark the vertex as "first" and add it to the list
-	select->state = vertex::first;
-	hull.push_front (vertex (lr_point));
+double search::ipf_circle (double p, double a)
+{
+	return ipf_circle<throw_on_error> (p, a);
+}
 
-	// 2 last added to the convex hull
-	point last_added (lr_point), previous (lr_point);
+double search::opf_circle (double z, double a)
+{
+	return opf_circle<throw_on_error> (z, a);
+}
 
-	// initial location exactly on the left from last_added
-	previous.x = previous.x - 1.0;
+double search::iopf_circle (double p, double a)
+{
+	return iopf_circle<throw_on_error> (p, a);
+}
 
-	// main loop
+double search::pf_rectangle (double z, double a, double b)
+{
+	return pf_rectangle<throw_on_error> (z, a, b);
+}
 
-	for (;;)
-	{
-		double
-			min_ang (6.29), // > 2*pi
-			max_dist (0.0);
+double search::ipf_rectangle (double p, double a, double b)
+{
+	return ipf_rectangle<throw_on_error> (p, a, b);
+}
 
-		// find new vertice for the convex hull
-		for (iter = vertices.begin (); iter != vertices.end (); ++iter)
-		{
-			// check if vertex is already a part of the hull
-			if (iter->state == vertex::used)
-			{
-				continue;
-			}
+double search::opf_rectangle (double z, double a, double b)
+{
+	return opf_rectangle<throw_on_error> (z, a, b);
+}
 
-			// check for duplicates;
-			// skip if iter points to last_added;
-			// also, make sure the first iteration is correct
-			if (iter->coord == last_added)
-			{
-				continue;
-			}
+double search::iopf_rectangle (double p, double a, double b)
+{
+	return iopf_rectangle<throw_on_error> (p, a, b);
+}
 
-			// calculate the angle between the three points
-			double
-				ang (last_added.angle (
-					last_added*2.0 - previous, iter->coord)),
-				dist ((iter->coord - last_added).abs ());
+double search::pf_3d (double z)
+{
+	return pf_3d<throw_on_error> (z);
+}
 
-			if (ang < min_ang || (ang == min_ang && dist > max_dist))
-			{
-				min_ang = ang;
-				max_dist = dist;
+double search::ipf_3d (double p)
+{
+	return ipf_3d<throw_on_error> (p);
+}
 
-				// save the position
-				select = iter;
-			}
-		}
+double search::pf_sphere_3d (double z, double a)
+{
+	return pf_sphere_3d<throw_on_error> (z, a);
+}
+
+//
+// Note: the batch versions below evaluate the closed forms
+// in pairs with SSE2 kernels repeating the single versions
+// operation by operation, so that the results are the same.
+// The others call the unchecked single versions for the valid
+// elements.
+//
 
-		// if the selected vertice is "first," we're done
-		if (select->state == vertex::first)
+size_t search::pf_plane (
+	const double* z, size_t count, double* out, bool* in_range)
+{
+	return batch (
+		z, count, out, in_range, pos_infinity, false,
+		[] (double z) { return pf_plane<unchecked> (z); }
+#ifdef SEARCH_CPP_SSE2
+		, [] (__m128d z)
 		{
-			break;
+			return _mm_mul_pd (_mm_set1_pd (2.0*sqrt (pi)), _mm_sqrt_pd (z));
 		}
-		else
-		{
-			// add the selected vertice to the convex hull
-			// and prepare to the next iteration
+#endif // SEARCH_CPP_SSE2
+		);
+}
 
-			hull.push_front (vertex (select->coord));
-			select->state = vertex::used;
-			previous = last_added;
-			last_added = select->coord;
+size_t search::ipf_plane (
+	const double* p, size_t count, double* out, bool* in_range)
+{
+	return batch (
+		p, count, out, in_range, pos_infinity, false,
+		[] (double p) { return ipf_plane<unchecked> (p); }
+#ifdef SEARCH_CPP_SSE2
+		, [] (__m128d p)
+		{
+			return _mm_mul_pd (_mm_div_pd (p, _mm_set1_pd (4.0*pi)), p);
 		}
-	}
-
-	vertices.swap (hull);
+#endif // SEARCH_CPP_SSE2
+		);
 }
 
-search::convex_polygon_pf::convex_polygon_pf (
-	const convex_polygon& cp)
-	: num_vertices_v (cp.num_vertices ()), area_v (cp.area ()),
-	  half_area_v (area_v / 2.0), sides (num_vertices_v),
-	  function (0), tmp_function (0),
-	  pf_ok (false), pf_max_ok (false), sc_ok (false),
-	  maximum_v (0.0), num_segments_v (0)
+size_t search::pf_angle (
+	const double* z, size_t count, double* out,
+	double theta, bool* in_range)
 {
-	// fill in the array of cp sides
-
-	// since cp.convex_hull has stored the vertices in clockwise order,
-	// the sides will be stored in clockwise order, too
+	static const char* const name_of_fun (
+		"pf_angle(const double*,size_t,double*,double,bool*)");
 
-	convex_polygon::const_iterator iter (cp.begin ());
-
-	if (num_vertices () > 2)
+	if (is_nan (theta, name_of_fun) ||
+		out_of_range (0.0 < theta && theta < 2.0*pi, name_of_fun))
 	{
-		convex_polygon::point first (*iter);
-		cyclic_uint index (this);
-
-		unsigned skipped (0);
+		return batch_out_of_range (count, out, in_range);
+	}
 
-		while (index != num_vertices () - 1)
+	return batch (
+		z, count, out, in_range, pos_infinity, false,
+		[=] (double z) { return pf_angle<unchecked> (z, theta); }
+#ifdef SEARCH_CPP_SSE2
+		, [factor = sqrt (2.0*std::min (theta, pi))] (__m128d z)
 		{
-			convex_polygon::point p (*iter);
-			++iter;
-			convex_polygon::point q (*iter);
+			return _mm_mul_pd (_mm_set1_pd (factor), _mm_sqrt_pd (z));
+		}
+#endif // SEARCH_CPP_SSE2
+		);
+}
 
-			// no sides with (p - q).abs = 0 will be present
-			if ((p - q).abs () == 0.0)
-			{
-				++index;
-				++skipped;
-				continue;
-			}
+size_t search::ipf_angle (
+	const double* p, size_t count, double* out,
+	double theta, bool* in_range)
+{
+	static const char* const name_of_fun (
+		"ipf_angle(const double*,size_t,double*,double,bool*)");
 
-			(*this) [index++] = side (p, q);
-		}
+	if (is_nan (theta, name_of_fun) ||
+		out_of_range (0.0 < theta && theta < 2.0*pi, name_of_fun))
+	{
+		return batch_out_of_range (count, out, in_range);
+	}
 
-		if ((*iter - first).abs () != 0.0)
+	return batch (
+		p, count, out, in_range, pos_infinity, false,
+		[=] (double p) { return ipf_angle<unchecked> (p, theta); }
+#ifdef SEARCH_CPP_SSE2
+		, [factor = 2.0*std::min (theta, pi)] (__m128d p)
 		{
-			(*this) [index] = side (*iter, first);
+			return _mm_mul_pd (_mm_div_pd (p, _mm_set1_pd (factor)), p);
 		}
-		else
-		{
-			++skipped;
-		}
-
-		num_vertices_v -= skipped;
-	}
+#endif // SEARCH_CPP_SSE2
+		);
 }
 
-double
-search::convex_polygon_pf::pf (double z)
+size_t search::pf_sphere (
+	const double* z, size_t count, double* out,
+	double a, bool* in_range)
 {
-	static const std::string name_of_fun ("convex_polygon_pf::pf(double)");
+	static const char* const name_of_fun (
+		"pf_sphere(const double*,size_t,double*,double,bool*)");
 
-	if (is_nan (z, name_of_fun))
+	if (is_nan (a, name_of_fun) || out_of_range (0.0 < a, name_of_fun))
 	{
-		return qnan;
+		return batch_out_of_range (count, out, in_range);
 	}
 
-	if (out_of_range (0.0 <= z && z <= area () && z < pos_infinity, name_of_fun))
-	{
-		return qnan;
-	}
+	return batch (
+		z, count, out, in_range, 4.0*pi*a*a, true,
+		[=] (double z) { return pf_sphere<unchecked> (z, a); }
+#ifdef SEARCH_CPP_SSE2
+		, [aa_4 = 4.0*a*a] (__m128d z)
+		{
+			return _mm_mul_pd (
+				_mm_mul_pd (_mm_set1_pd (2.0), _mm_sqrt_pd (z)),
+				_mm_sqrt_pd (_mm_sub_pd (
+					_mm_set1_pd (pi), _mm_div_pd (z, _mm_set1_pd (aa_4)))));
+		}
+#endif // SEARCH_CPP_SSE2
+		);
+}
 
-	if (!pf_ok)
-	{
-		find_pf ();
-	}
+size_t search::ipf_sphere (
+	const double* p, size_t count, double* out,
+	double a, bool* in_range)
+{
+	static const char* const name_of_fun (
+		"ipf_sphere(const double*,size_t,double*,double,bool*)");
 
-	if (z > half_area ())
+	if (is_nan (a, name_of_fun) || out_of_range (0.0 < a, name_of_fun))
 	{
-		z = area () - z;
+		return batch_out_of_range (count, out, in_range);
 	}
 
-	//replace with less trivial search for large num_segments()
-	for (unsigned index = 0; index < num_segments (); ++index)
-	{
-		if (z <= function [index].b)
+	return batch (
+		p, count, out, in_range, 2.0*pi*a, true,
+		[=] (double p) { return ipf_sphere<unchecked> (p, a); }
+#ifdef SEARCH_CPP_SSE2
+		, [a, pi_a_2 = 2.0*pi*a] (__m128d p)
 		{
-			return function [index].pf (z);
+			const __m128d
+				one (_mm_set1_pd (1.0)),
+				tmp (_mm_div_pd (p, _mm_set1_pd (pi_a_2))),
+				root (_mm_sqrt_pd (_mm_sub_pd (one, _mm_mul_pd (tmp, tmp))));
+
+			return _mm_mul_pd (
+				_mm_set1_pd (2.0*pi),
+				_mm_mul_pd (
+					_mm_mul_pd (_mm_set1_pd (a), _mm_sub_pd (one, root)),
+					_mm_set1_pd (a)));
 		}
-	}
-
-	return qnan; // unreachable
+#endif // SEARCH_CPP_SSE2
+		);
 }
 
-double
-search::convex_polygon_pf::ipf (double p)
+size_t search::pf_circle (
+	const double* z, size_t count, double* out,
+	double a, bool* in_range)
 {
-	static const std::string name_of_fun ("convex_polygon_pf::ipf(double)");
+	static const char* const name_of_fun (
+		"pf_circle(const double*,size_t,double*,double,bool*)");
 
-	if (is_nan (p, name_of_fun))
+	if (is_nan (a, name_of_fun) || out_of_range (0.0 <= a, name_of_fun))
 	{
-		return qnan;
+		return batch_out_of_range (count, out, in_range);
 	}
 
-	if (!pf_ok)
-	{
-		find_pf ();
-	}
+	return batch (
+		z, count, out, in_range, pi*a*a, true,
+		[=] (double z) { return pf_circle<unchecked> (z, a); });
+}
 
-	if (out_of_range (0.0 <= p && p <= maximum () && p < pos_infinity, name_of_fun))
-	{
-		return qnan;
-	}
+size_t search::ipf_circle (
+	const double* p, size_t count, double* out,
+	double a, bool* in_range)
+{
+	static const char* const name_of_fun (
+		"ipf_circle(const double*,size_t,double*,double,bool*)");
 
-	for (unsigned index = 0; index < num_segments (); ++index)
+	if (is_nan (a, name_of_fun) || out_of_range (0.0 <= a, name_of_fun))
 	{
-		if (function [index].pfb >= p)
-		{
-			return function [index].ipf (p);
-		}
+		return batch_out_of_range (count, out, in_range);
 	}
 
-	return qnan; // unreachable
+	return batch (
+		p, count, out, in_range, 2.0*a, true,
+		[=] (double p) { return ipf_circle<unchecked> (p, a); });
 }
 
-double
-search::convex_polygon_pf::maximum ()
+size_t search::opf_circle (
+	const double* z, size_t count, double* out,
+	double a, bool* in_range)
 {
-	if (!pf_max_ok)
+	static const char* const name_of_fun (
+		"opf_circle(const double*,size_t,double*,double,bool*)");
+
+	if (is_nan (a, name_of_fun) || out_of_range (0.0 <= a, name_of_fun))
 	{
-		find_pf_max ();
+		return batch_out_of_range (count, out, in_range);
 	}
 
-	return maximum_v;
+	// z and a can't be infinite at the same time
+
+	return batch (
+		z, count, out, in_range, pos_infinity, a == pos_infinity,
+		[=] (double z) { return opf_circle<unchecked> (z, a); });
 }
 
-unsigned
-search::convex_polygon_pf::num_segments ()
+size_t search::iopf_circle (
+	const double* p, size_t count, double* out,
+	double a, bool* in_range)
 {
-	if (!pf_ok)
+	static const char* const name_of_fun (
+		"iopf_circle(const double*,size_t,double*,double,bool*)");
+
+	if (is_nan (a, name_of_fun) || out_of_range (0.0 <= a, name_of_fun))
 	{
-		find_pf ();
+		return batch_out_of_range (count, out, in_range);
 	}
 
-	return num_segments_v;
+	// p and a can't be infinite at the same time
+
+	return batch (
+		p, count, out, in_range, pos_infinity, a == pos_infinity,
+		[=] (double p) { return iopf_circle<unchecked> (p, a); });
 }
 
-double
-search::convex_polygon_pf::a (unsigned index)
+size_t search::pf_rectangle (
+	const double* z, size_t count, double* out,
+	double a, double b, bool* in_range)
 {
-	static const std::string name_of_fun ("convex_polygon_pf::a(unsigned)");
+	static const char* const name_of_fun (
+		"pf_rectangle(const double*,size_t,double*,double,double,bool*)");
 
-	if (!pf_ok)
+	if (is_nan (a, b, name_of_fun) ||
+		out_of_range (0.0 <= a && a < pos_infinity, name_of_fun) ||
+		out_of_range (0.0 <= b && b < pos_infinity, name_of_fun))
 	{
-		find_pf ();
+		return batch_out_of_range (count, out, in_range);
 	}
 
-	const unsigned num_segments (this->num_segments ());
+	return batch (
+		z, count, out, in_range, a*b, true,
+		[=] (double z) { return pf_rectangle<unchecked> (z, a, b); }
+#ifdef SEARCH_CPP_SSE2
+		, [a = std::min (a, b), b = std::max (a, b)] (__m128d z)
+		{
+			const double ab_2 ((a/2.0)*b);
+			const double z_max ((a/pi)*a);
 
-	if (out_of_range (index <= num_segments, name_of_fun))
-	{
-		return qnan;
-	}
+			const __m128d
+				half (_mm_set1_pd (ab_2)),
+				upper_half (_mm_cmpgt_pd (z, half));
 
-	const unsigned max_index ((num_segments - 1) >> 1);
+			// z = ab_2 - (z - ab_2) if z > ab_2
 
-	if (index <= max_index)
+			z = _mm_or_pd (
+				_mm_and_pd (upper_half, _mm_sub_pd (half, _mm_sub_pd (z, half))),
+				_mm_andnot_pd (upper_half, z));
+
+			const __m128d small (_mm_cmplt_pd (z, _mm_set1_pd (z_max)));
+
+			return _mm_or_pd (
+				_mm_and_pd (small,
+					_mm_mul_pd (_mm_set1_pd (sqrt (pi)), _mm_sqrt_pd (z))),
+				_mm_andnot_pd (small, _mm_set1_pd (a)));
+		}
+#endif // SEARCH_CPP_SSE2
+		);
+}
+
+size_t search::ipf_rectangle (
+	const double* p, size_t count, double* out,
+	double a, double b, bool* in_range)
+{
+	static const char* const name_of_fun (
+		"ipf_rectangle(const double*,size_t,double*,double,double,bool*)");
+
+	if (is_nan (a, b, name_of_fun) ||
+		out_of_range (0.0 <= a && a < pos_infinity, name_of_fun) ||
+		out_of_range (0.0 <= b && b < pos_infinity, name_of_fun))
 	{
-		return function [index].a;
+		return batch_out_of_range (count, out, in_range);
 	}
-	else
-	if (index == max_index + 1)
-	{
-		if ((num_segments & 1) == 0)
-		{
-			return half_area ();
-		}
-		else
+
+	return batch (
+		p, count, out, in_range, std::min (a, b), true,
+		[=] (double p) { return ipf_rectangle<unchecked> (p, a, b); }
+#ifdef SEARCH_CPP_SSE2
+		, [] (__m128d p)
 		{
-			return area() - function [num_segments - index].a;
+			return _mm_mul_pd (_mm_div_pd (p, _mm_set1_pd (pi)), p);
 		}
-	}
-	else
-	{
-		return area() - function [num_segments - index].a;
-	}
+#endif // SEARCH_CPP_SSE2
+		);
 }
 
-double
-search::convex_polygon_pf::theta (unsigned index)
+size_t search::opf_rectangle (
+	const double* z, size_t count, double* out,
+	double a, double b, bool* in_range)
 {
-	static const std::string name_of_fun ("convex_polygon_pf::theta(unsigned)");
+	static const char* const name_of_fun (
+		"opf_rectangle(const double*,size_t,double*,double,double,bool*)");
 
-	if (!pf_ok)
+	if (is_nan (a, b, name_of_fun) ||
+		out_of_range (0.0 <= a && a < pos_infinity, name_of_fun) ||
+		out_of_range (0.0 <= b && b < pos_infinity, name_of_fun))
 	{
-		find_pf ();
+		return batch_out_of_range (count, out, in_range);
 	}
 
-	const unsigned num_segments (this->num_segments ());
+	return batch (
+		z, count, out, in_range, pos_infinity, false,
+		[=] (double z) { return opf_rectangle<unchecked> (z, a, b); });
+}
 
-	if (out_of_range (1 <= index && index <= num_segments, name_of_fun))
+size_t search::iopf_rectangle (
+	const double* p, size_t count, double* out,
+	double a, double b, bool* in_range)
+{
+	static const char* const name_of_fun (
+		"iopf_rectangle(const double*,size_t,double*,double,double,bool*)");
+
+	if (is_nan (a, b, name_of_fun) ||
+		out_of_range (0.0 <= a && a < pos_infinity, name_of_fun) ||
+		out_of_range (0.0 <= b && b < pos_infinity, name_of_fun))
 	{
-		return qnan;
+		return batch_out_of_range (count, out, in_range);
 	}
 
-	--index;
+	return batch (
+		p, count, out, in_range, pos_infinity, false,
+		[=] (double p) { return iopf_rectangle<unchecked> (p, a, b); });
+}
 
-	const unsigned max_index ((num_segments - 1) >> 1);
+size_t search::pf_3d (
+	const double* z, size_t count, double* out, bool* in_range)
+{
+	return batch (
+		z, count, out, in_range, pos_infinity, false,
+		[] (double z) { return pf_3d<unchecked> (z); });
+}
 
-	if (index <= max_index)
-	{
-		return function [index].theta;
-	}
-	else
-	{
-		return -function [num_segments - index - 1].theta;
-	}
+size_t search::ipf_3d (
+	const double* p, size_t count, double* out, bool* in_range)
+{
+	return batch (
+		p, count, out, in_range, pos_infinity, false,
+		[] (double p) { return ipf_3d<unchecked> (p); }
+#ifdef SEARCH_CPP_SSE2
+		, [] (__m128d p)
+		{
+			return _mm_sqrt_pd (_mm_mul_pd (
+				_mm_mul_pd (_mm_div_pd (p, _mm_set1_pd (36.0*pi)), p), p));
+		}
+#endif // SEARCH_CPP_SSE2
+		);
 }
 
-double
-search::convex_polygon_pf::zeta (unsigned index)
+size_t search::pf_sphere_3d (
+	const double* z, size_t count, double* out,
+	double a, bool* in_range)
 {
-	static const std::string name_of_fun ("convex_polygon_pf::zeta(unsigned)");
+	static const char* const name_of_fun (
+		"pf_sphere_3d(const double*,size_t,double*,double,bool*)");
 
-	if (!pf_ok)
+	if (is_nan (a, name_of_fun) || out_of_range (0.0 <= a, name_of_fun))
 	{
-		find_pf ();
+		return batch_out_of_range (count, out, in_range);
 	}
 
-	const unsigned num_segments (this->num_segments ());
+	return batch (
+		z, count, out, in_range, (4.0*pi/3.0)*a*a*a, true,
+		[=] (double z) { return pf_sphere_3d<unchecked> (z, a); });
+}
 
-	if (out_of_range (1 <= index && index <= num_segments, name_of_fun))
-	{
-		return qnan;
-	}
+//
+// Note: in the grid versions of the gain functions below,
+// f(w,r) = 2*r * (w*(pi - acos(w)) + sqrt(1 - w^2)) and
+// g(w,r) = pi*r*r * (1 + w)^2 are products of the factors
+// depending on r only, evaluated once per column, and on w only,
+// evaluated once per row.  h shares h_column among the rows,
+// and evaluates the pairs of rows with SSE2 if it is available.
+// The operations are the same as in the single versions.
+//
 
-	--index;
+size_t search::f (
+	const double* w, size_t num_w, const double* r, size_t num_r,
+	double* out, unsigned num_threads)
+{
+	// 2*r, or NaN if r is out of range
 
-	const unsigned max_index ((num_segments - 1) >> 1);
+	std::vector<double> column (num_r, qnan);
+	size_t num_valid_r (0);
 
-	if (index <= max_index)
+	for (size_t j = 0; j < num_r; ++j)
 	{
-		return function [index].zeta;
+		if (0.0 <= r [j])
+		{
+			column [j] = 2.0*r [j];
+			++num_valid_r;
+		}
 	}
-	else
+
+	size_t num_valid_w (0);
+
+	for (size_t i = 0; i < num_w; ++i)
 	{
-		return -area () - function [num_segments - index - 1].zeta;
+		num_valid_w += 0.0 <= w [i] && w [i] <= 1.0;
 	}
+
+	grid (num_w, num_r, num_threads,
+		[&] (size_t first, size_t last)
+		{
+			for (size_t i = first; i < last; ++i)
+			{
+				double* const row (out + i*num_r);
+
+				if (!(0.0 <= w [i] && w [i] <= 1.0))
+				{
+					std::fill (row, row + num_r, qnan);
+					continue;
+				}
+
+				const double factor (
+					w [i]*(pi - acos (w [i])) + sqrt (1.0 - w [i]*w [i]));
+
+				for (size_t j = 0; j < num_r; ++j)
+				{
+					row [j] = column [j]*factor;
+				}
+			}
+		});
+
+	return num_w*num_r - num_valid_w*num_valid_r;
 }
 
-double
-search::convex_polygon_pf::shortest (
-	bool& is_arc, convex_polygon::point& start,
-	convex_polygon::point& end, convex_polygon::point& center)
+size_t search::g (
+	const double* w, size_t num_w, const double* r, size_t num_r,
+	double* out, unsigned num_threads)
 {
-	if (!sc_ok)
+	// pi*r*r, or NaN if r is out of range
+
+	std::vector<double> column (num_r, qnan);
+	size_t num_valid_r (0);
+
+	for (size_t j = 0; j < num_r; ++j)
 	{
-		find_pf_max ();
+		if (0.0 <= r [j])
+		{
+			column [j] = pi*r [j]*r [j];
+			++num_valid_r;
+		}
 	}
 
-	if (maximum () == 0.0)
+	size_t num_valid_w (0);
+
+	for (size_t i = 0; i < num_w; ++i)
 	{
-		return 0.0;
+		num_valid_w += 0.0 <= w [i] && w [i] <= 1.0;
 	}
 
-	is_arc = (shortest_curve.form == partial_pf::sqrt);
+	grid (num_w, num_r, num_threads,
+		[&] (size_t first, size_t last)
+		{
+			for (size_t i = first; i < last; ++i)
+			{
+				double* const row (out + i*num_r);
 
-	start = shortest_curve.start;
-	end = shortest_curve.end;
+				if (!(0.0 <= w [i] && w [i] <= 1.0))
+				{
+					std::fill (row, row + num_r, qnan);
+					continue;
+				}
 
-	if (is_arc)
-	{
-		center = shortest_curve.center;
-	}
+				const double tmp (1.0 + w [i]);
 
-	return maximum ();
+				for (size_t j = 0; j < num_r; ++j)
+				{
+					row [j] = column [j]*tmp*tmp;
+				}
+			}
+		});
+
+	return num_w*num_r - num_valid_w*num_valid_r;
 }
 
-double
-search::convex_polygon_pf::area (
-	cyclic_uint index_1, cyclic_uint index_2) const
+size_t search::h (
+	const double* w, size_t num_w, const double* r, size_t num_r,
+	double* out, double a, unsigned num_threads)
 {
-	double area (0.0);
-	++index_1;
+	static const char* const name_of_fun (
+		"h(const double*,size_t,const double*,size_t,double*,double,unsigned)");
 
-	if (index_1 == index_2)
+	if (is_nan (a, name_of_fun) || out_of_range (0.0 < a, name_of_fun))
 	{
-		return 0.0;
+		return batch_out_of_range (num_w*num_r, out, 0);
 	}
 
-	const convex_polygon::point point ((*this) [index_1].p);
+	std::vector<h_column> columns;
+	std::vector<bool> valid_r (num_r);
+	size_t num_valid_r (0);
 
-	for (++index_1; index_1 != index_2; ++index_1)
-	{
-		area += point.area ((*this) [index_1].p, (*this) [index_1].q);
-	}
-
-	return area;
-}
+	columns.reserve (num_r);
 
-double
-search::convex_polygon_pf::area (
-	cyclic_uint index_1, cyclic_uint index_2,
-	const convex_polygon::point& point) const
-{
-	double area (0.0);
-	
-	for (++index_1; index_1 != index_2; ++index_1)
+	for (size_t j = 0; j < num_r; ++j)
 	{
-		area += point.area ((*this) [index_1].p, (*this) [index_1].q);
+		columns.push_back (h_column (r [j]/a));
+		valid_r [j] = 0.0 <= r [j] && r [j] <= pi*a && !_isnan (r [j]/a);
+		num_valid_r += valid_r [j];
 	}
 
-	return area;
-}
+	auto valid_w = [=] (size_t i)
+	{
+		return 0.0 <= w [i] && w [i] <= 1.0;
+	};
 
-void
-search::convex_polygon_pf::find_pf ()
-{
-	// fictious node to avoid handling holes in the definition domain,
-	// also, this will be a "stub" node in the case num_vertices < 3
-	tmp_function = new partial_pf_node (0.0, half_area (), sqrt (10.0*pi*area ()));
+	size_t num_valid_w (0);
 
-	if (num_vertices () > 2)
+	for (size_t i = 0; i < num_w; ++i)
 	{
-		cyclic_uint index_1 (this), index_2 (this);
+		num_valid_w += valid_w (i);
+	}
 
-		// check all pairs of sides
-		for (index_1 = 1; index_1 != 0; ++index_1)
+	grid (num_w, num_r, num_threads,
+		[&] (size_t first, size_t last)
 		{
-			for (index_2 = 0; index_2 != index_1; ++index_2)
+			for (size_t i = first; i < last; ++i)
 			{
-				// "partial" perimeter function of the two sides
-				const partial_pf ppf (*this, index_1, index_2);
+				double* const row (out + i*num_r);
 
-				// empty definition domain
-				if (ppf.form == partial_pf::none)
+				if (!valid_w (i))
 				{
+					std::fill (row, row + num_r, qnan);
 					continue;
 				}
 
-				// iterators
-				partial_pf_node (*iter)(tmp_function), (*save)(0);
-
-				// find left "insertion point"
-
-				double left, right;
-				bool f_left, f_right;
+#ifdef SEARCH_CPP_SSE2
 
-				new_loop:
-
-				for (; iter != 0; iter = iter->next)
+				if (i + 1 < last && valid_w (i + 1))
 				{
-					if (iter->begin (ppf, left, right, f_left, f_right))
+					const __m128d pair (_mm_set_pd (w [i + 1], w [i]));
+					double* const next_row (row + num_r);
+
+					for (size_t j = 0; j < num_r; ++j)
 					{
-						break;
+						if (!valid_r [j])
+						{
+							row [j] = next_row [j] = qnan;
+						}
+						else
+						if (columns [j].regular ())
+						{
+							const __m128d result (columns [j] (pair, a));
+							_mm_storel_pd (row + j, result);
+							_mm_storeh_pd (next_row + j, result);
+						}
+						else
+						{
+							row [j] = columns [j] (w [i], a);
+							next_row [j] = columns [j] (w [i + 1], a);
+						}
 					}
-				}
 
-				// ppf isn't represented in the perimeter function
-				if (iter == 0)
-				{
+					++i;
 					continue;
 				}
 
-				if (!f_left)
-				{
-					// left "insertion point" doesn't coincide with
-					// the left boundary of the iter definition domain:
-					// adding a new node
-
-					partial_pf_node* new_node = new partial_pf_node (*iter);
-					iter->b = left;
-					iter->pfb = iter->pf (left);
-					iter->next = new_node;
-					iter = new_node;
-				}
+#endif // SEARCH_CPP_SSE2
 
-				if (!f_right)
+				for (size_t j = 0; j < num_r; ++j)
 				{
-					// right insertion already found, adding a new node
-
-					partial_pf_node* new_node = new partial_pf_node (*iter);
-					*((partial_pf*)(iter)) = ppf;
-					iter->a = left;
-					iter->pfa = iter->pf (left);
-					iter->b = right;
-					iter->pfb = iter->pf (right);
-					iter->next = new_node;
-					new_node->a = right;
-					new_node->pfa = new_node->pf (right);
-					iter = new_node->next;
-
-					goto new_loop;
+					row [j] = valid_r [j] ? columns [j] (w [i], a) : qnan;
 				}
+			}
+		});
+
+	return num_w*num_r - num_valid_w*num_valid_r;
+}
 
-				// insert ppf; right boundary is not known yet
-				*((partial_pf*)(iter)) = ppf;
-				iter->a = left;
-				iter->pfa = iter->pf (left);
+//
+// Note: the functions of namespace fast use the tables of
+// the normalized functions built by the exact functions on
+// first use.  The variables are chosen so that the tabulated
+// functions are smooth:
+//
+// pf_circle:   p/s    of s = sqrt(z),  0 <= z <= pi/2,
+// ipf_circle:  z/p^2  of p,            0 <= p <= 1,
+//              z      of q = sqrt(2 - p), 1 <= p <= 2,
+// opf_circle:  p/s    of s = sqrt(z),  0 <= z <= 1,
+//              p*t    of t = 1/sqrt(z), 1 <= z,
+// iopf_circle: z/p^2  of p,            0 <= p <= 2,
+//              z*t^2  of t = 1/p,       2 <= p.
+//
+// Any other arguments (invalid, zero, infinite, etc.)
+// are passed to the exact functions.
+//
 
-				// save so as to be able to fill in the right boundary
-				save = iter;
+double search::fast::pf_circle (double z, double a)
+{
+	if (!(0.0 < a && a < pos_infinity && 0.0 < z && z <= pi*a*a))
+	{
+		return search::pf_circle (z, a);
+	}
 
-				// another iterator storing previous position
-				partial_pf_node* prev = iter;
+	double z_norm (z/a);
+	z_norm /= a;
 
-				iter = iter->next;
+	if (z_norm > pi/2.0)
+	{
+		z_norm = pi - z_norm;
+	}
 
-				// find right "insertion point"
-				while (iter != 0)
-				{
-					if (iter->end (ppf, right, f_left))
-					{
-						break;
-					}
-					else
-					{
-						// node totally removed
-						prev->next = iter->next;
-						iter->next = 0;
-						delete iter;
-						iter = prev->next;
-					}
-				}
+	if (!(z_norm > 0.0))
+	{
+		return search::pf_circle (z, a);
+	}
 
-				// fill in right boundary
-				save->b = right;
-				save->pfb = save->pf (right);
+	static const chebyshev_table table (
+		[] (double s) { return search::pf_circle (s*s)/s; },
+		0.0, sqrt (pi/2.0), 64, 7);
 
-				if (iter != 0 && !f_left)
-				{
-					// right "insertion point" doesn't coincide with
-					// the beginning of a node; shifting the beginning.
-					iter->a	= right;
-					iter->pfa = iter->pf (right);
-				}
+	const double s (sqrt (z_norm));
+	return a*(table (s)*s);
+}
 
-				// while iter != 0
-				goto new_loop;
-			}
-		}
+double search::fast::ipf_circle (double p, double a)
+{
+	if (!(0.0 < a && a < pos_infinity && 0.0 < p && p <= 2.0*a))
+	{
+		return search::ipf_circle (p, a);
 	}
 
-	pf_ok = pf_max_ok = true;
+	const double p_norm (p/a);
+
+	if (!(0.0 < p_norm && p_norm < 2.0))
+	{
+		return search::ipf_circle (p, a);
+	}
 
-	// count the number of segments
+	double result;
 
-	partial_pf_node (*iter)(tmp_function);
+	if (p_norm <= 1.0)
+	{
+		static const chebyshev_table table (
+			[] (double p) { return search::ipf_circle (p)/(p*p); },
+			0.0, 1.0, 64, 7);
 
-	for (; iter != 0; iter = iter->next)
+		result = p_norm*table (p_norm)*p_norm;
+	}
+	else
 	{
-		++num_segments_v;
+		static const chebyshev_table table (
+			[] (double q) { return search::ipf_circle (2.0 - q*q); },
+			0.0, 1.0, 64, 7);
+
+		result = table (sqrt (2.0 - p_norm));
 	}
 
-	function = new partial_pf [num_segments_v];
+	return a*result*a;
+}
 
-	for (
-		iter = tmp_function, num_segments_v = 0;
-		iter != 0;
-		iter = iter->next, ++num_segments_v)
+double search::fast::opf_circle (double z, double a)
+{
+	if (!(0.0 < a && a < pos_infinity && 0.0 < z && z < pos_infinity))
 	{
-		function [num_segments_v] = partial_pf (*iter);
+		return search::opf_circle (z, a);
 	}
 
-	maximum_v = function [num_segments_v - 1].pfb;
+	double z_norm (z/a);
+	z_norm /= a;
 
-	if (function [num_segments_v - 1].form == partial_pf::constant)
+	if (!(0.0 < z_norm && z_norm < pos_infinity))
 	{
-		num_segments_v = num_segments_v*2 - 1;
+		return search::opf_circle (z, a);
+	}
+
+	double result;
+
+	if (z_norm <= 1.0)
+	{
+		static const chebyshev_table table (
+			[] (double s) { return search::opf_circle (s*s)/s; },
+			0.0, 1.0, 64, 7);
+
+		const double s (sqrt (z_norm));
+		result = table (s)*s;
 	}
 	else
 	{
-		num_segments_v = num_segments_v*2;
+		static const chebyshev_table table (
+			[] (double t) { return search::opf_circle (1.0/(t*t))*t; },
+			0.0, 1.0, 64, 7);
+
+		const double t (1.0/sqrt (z_norm));
+		result = table (t)/t;
 	}
 
-	delete tmp_function;
+	return a*result;
 }
 
-void
-search::convex_polygon_pf::find_pf_max ()
+double search::fast::iopf_circle (double p, double a)
 {
-	if (num_vertices () < 3)
+	if (!(0.0 < a && a < pos_infinity && 0.0 < p && p < pos_infinity))
 	{
-		maximum_v = 0.0;
-		pf_max_ok = true;
-		
-		// sc_ok remains false
+		return search::iopf_circle (p, a);
+	}
 
-		return;
+	const double p_norm (p/a);
+
+	if (!(0.0 < p_norm && p_norm < pos_infinity))
+	{
+		return search::iopf_circle (p, a);
 	}
 
-	cyclic_uint
-		index_1 (this), index_2 (this),
-		save_index_1 (this), save_index_2 (this);
+	double result;
 
-	// will accumulate the maximum
-	double max (sqrt (pi*area ()));
+	if (p_norm <= 2.0)
+	{
+		static const chebyshev_table table (
+			[] (double p) { return search::iopf_circle (p)/(p*p); },
+			0.0, 2.0, 64, 7);
 
-	// check all pairs of sides
-	for (index_1 = 1; index_1 != 0; ++index_1)
+		result = p_norm*table (p_norm)*p_norm;
+	}
+	else
 	{
-		for (index_2 = 0; index_2 != index_1; ++index_2)
-		{
-			// "partial" perimeter function of the two sides
-			const partial_pf ppf (*this, index_1, index_2);
+		static const chebyshev_table table (
+			[] (double t) { return search::iopf_circle (1.0/t)*t*t; },
+			0.0, 0.5, 64, 7);
 
-			// empty definition domain
-			if (ppf.form == partial_pf::none)
-			{
-				continue;
-			}
+		result = p_norm*table (1.0/p_norm)*p_norm;
+	}
 
-			// arg max outside definition domain
-			if (ppf.b < half_area ())
-			{
-				continue;
-			}
+	return a*result*a;
+}
 
-			// update
-			if (ppf.pfb < max)
-			{
-				max = ppf.pfb;
-				save_index_1 = index_1;
-				save_index_2 = index_2;
-			}
-		}
+double
+search::convex_polygon::area () const
+{
+	const size_t n (vertices.size ());
+
+	if (n < 3)
+	{
+		return 0.0;
 	}
 
-	// "partial" perimeter function of the two sides
-	partial_pf ppf (*this, save_index_1, save_index_2, &shortest_curve);
+	// shoelace formula; the origin is moved to the first vertex
+
+	const point origin (vertices [0]);
+	size_t index (1);
+
+#ifdef SEARCH_CPP_SSE2
+
+	// the lanes accumulate x[i]*y[i + 1] and y[i]*x[i + 1]
+	// for even and odd i separately
+
+	const __m128d o (_mm_loadu_pd (&origin.x));
+	__m128d
+		even (_mm_setzero_pd ()),
+		odd (_mm_setzero_pd ()),
+		p (_mm_sub_pd (_mm_loadu_pd (&vertices [1].x), o));
+
+	for (; index + 2 < n; index += 2)
+	{
+		const __m128d
+			q (_mm_sub_pd (_mm_loadu_pd (&vertices [index + 1].x), o)),
+			r (_mm_sub_pd (_mm_loadu_pd (&vertices [index + 2].x), o));
+
+		even = _mm_add_pd (even, _mm_mul_pd (p, _mm_shuffle_pd (q, q, 1)));
+		odd = _mm_add_pd (odd, _mm_mul_pd (q, _mm_shuffle_pd (r, r, 1)));
+		p = r;
+	}
+
+	double lanes [2];
+	_mm_storeu_pd (lanes, _mm_add_pd (even, odd));
+	double area (lanes [0] - lanes [1]);
+
+#else // SEARCH_CPP_SSE2
+
+	double area (0.0);
+
+#endif // SEARCH_CPP_SSE2
+
+	for (; index + 1 < n; ++index)
+	{
+		area += (vertices [index] - origin)^(vertices [index + 1] - origin);
+	}
+
+	return fabs (area)/2.0;
+}
+
+void
+search::convex_polygon::convex_hull ()
+{
+	if (verify_convex ()) return; // nothing to do
+
+	hull_ok = true;
+
+	if (num_vertices () < 3) return; // nothing to do
+
+	// in the case num_vertices = 3 nothing to do either,
+	// but the resulting order of vertices is important
+
+	// Andrew's monotone chain; the vertices that don't make a left
+	// turn are dropped, so are the ones lying on the sides
+
+	monotone_chain (vertices,
+		[this] (const point& a, const point& b, const point& c)
+		{
+			return left_turn (a, b, c);
+		});
+}
+
+bool
+search::convex_polygon::left_turn (
+	const point& a, const point& b, const point& c) const
+{
+	const double cross ((b - a)^(c - a));
+
+	// the tangent of the turn is cross/dot; a turn by more
+	// than pi/2 (dot < 0) is never taken as straight
+
+	return exact_hull_v ? cross > 0.0 :
+		cross > std::max (0.0, hull_tolerance*((b - a)*(c - b)));
+}
+
+void
+search::convex_polygon::convex_hull (unsigned num_threads)
+{
+	// the smaller polygons are not worth the threads
+	static const size_t min_parallel (1 << 16);
+
+	const size_t n (vertices.size ());
+
+	if (verify_convex () || num_threads <= 1 || n < min_parallel)
+	{
+		convex_hull ();
+		return;
+	}
+
+	const size_t block_size ((n + num_threads - 1)/num_threads);
+	const unsigned num_blocks (unsigned ((n + block_size - 1)/block_size));
+
+	// (1) The extreme vertices in the directions x, x + y, y, y - x,
+	// -x, -x - y, -y, x - y, i.e. counterclockwise, in each block
+
+	std::vector<size_t> extreme (8*num_blocks);
+
+	auto values = [] (const point& vertex, double* value)
+	{
+		const double x (vertex.x), y (vertex.y);
+
+		value [0] = x;
+		value [1] = x + y;
+		value [2] = y;
+		value [3] = y - x;
+		value [4] = -x;
+		value [5] = -x - y;
+		value [6] = -y;
+		value [7] = x - y;
+	};
+
+	parallel_for (num_blocks, num_threads,
+		[&] (unsigned block)
+		{
+			const size_t first (block*block_size);
+			const size_t last (std::min (n, first + block_size));
+			size_t* const best_index (&extreme [8*block]);
+			double best [8], value [8];
+
+			size_t index (first + 1);
+
+			values (vertices [first], best);
+			std::fill (best_index, best_index + 8, first);
+
+#ifdef SEARCH_CPP_SSE2
+			// Two vertices at a time: the largest and the smallest
+			// x, x + y, y and y - x in each lane, with the indices
+			// held as doubles.  The lanes are then compared, the
+			// lower index winning a tie as in the loop below.  The
+			// smallest values make the directions -x, -x - y, -y
+			// and x - y, their negations being exact.
+
+			if (last - first >= 4)
+			{
+				__m128d high [4], low [4], high_index [4], low_index [4];
+				__m128d position (
+					_mm_set_pd (double (first + 1), double (first)));
+
+				auto load = [&] (size_t index, __m128d* value)
+				{
+					const __m128d
+						p (_mm_loadu_pd (&vertices [index].x)),
+						q (_mm_loadu_pd (&vertices [index + 1].x)),
+						x (_mm_unpacklo_pd (p, q)),
+						y (_mm_unpackhi_pd (p, q));
+
+					value [0] = x;
+					value [1] = _mm_add_pd (x, y);
+					value [2] = y;
+					value [3] = _mm_sub_pd (y, x);
+				};
+
+				auto select = [] (__m128d mask, __m128d a, __m128d b)
+				{
+					return _mm_or_pd (
+						_mm_and_pd (mask, a), _mm_andnot_pd (mask, b));
+				};
+
+				load (first, high);
+
+				for (unsigned k (0); k < 4; ++k)
+				{
+					low [k] = high [k];
+					high_index [k] = low_index [k] = position;
+				}
+
+				for (index = first + 2; index + 2 <= last; index += 2)
+				{
+					__m128d value [4];
+
+					load (index, value);
+					position = _mm_add_pd (position, _mm_set1_pd (2.0));
+
+					for (unsigned k (0); k < 4; ++k)
+					{
+						const __m128d
+							greater (_mm_cmpgt_pd (value [k], high [k])),
+							less (_mm_cmplt_pd (value [k], low [k]));
+
+						high [k] = select (greater, value [k], high [k]);
+						high_index [k] = select (greater, position, high_index [k]);
+						low [k] = select (less, value [k], low [k]);
+						low_index [k] = select (less, position, low_index [k]);
+					}
+				}
+
+				for (unsigned k (0); k < 4; ++k)
+				{
+					double value [2], position [2];
+
+					_mm_storeu_pd (value, high [k]);
+					_mm_storeu_pd (position, high_index [k]);
+
+					const unsigned
+						lane (value [1] > value [0] ||
+							(value [1] == value [0] && position [1] < position [0]));
+
+					best [k] = value [lane];
+					best_index [k] = size_t (position [lane]);
+
+					_mm_storeu_pd (value, low [k]);
+					_mm_storeu_pd (position, low_index [k]);
+
+					const unsigned
+						other (value [1] < value [0] ||
+							(value [1] == value [0] && position [1] < position [0]));
+
+					best [k + 4] = -value [other];
+					best_index [k + 4] = size_t (position [other]);
+				}
+			}
+#endif
+
+			for (; index < last; ++index)
+			{
+				values (vertices [index], value);
+
+				for (unsigned dir (0); dir < 8; ++dir)
+				{
+					if (value [dir] > best [dir])
+					{
+						best [dir] = value [dir];
+						best_index [dir] = index;
+					}
+				}
+			}
+		});
+
+	// the extreme vertices of the whole polygon, then the polygon
+	// made of them with the repeated vertices removed
+
+	std::vector<point> filter;
+
+	for (unsigned dir (0); dir < 8; ++dir)
+	{
+		size_t select (extreme [dir]);
+		double best [8], value [8];
+
+		values (vertices [select], best);
+
+		for (unsigned block (1); block < num_blocks; ++block)
+		{
+			values (vertices [extreme [8*block + dir]], value);
+
+			if (value [dir] > best [dir])
+			{
+				select = extreme [8*block + dir];
+				values (vertices [select], best);
+			}
+		}
+
+		if (filter.empty () || vertices [select] != filter.back ())
+		{
+			filter.push_back (vertices [select]);
+		}
+	}
+
+	while (filter.size () > 1 && filter.back () == filter.front ())
+	{
+		filter.pop_back ();
+	}
+
+	// the sides of the filter polygon: the inner points lie on the
+	// left of all of them
+
+	const size_t num_sides (filter.size () >= 3 ? filter.size () : 0);
+	std::vector<double>
+		ax (num_sides), ay (num_sides), dx (num_sides), dy (num_sides);
+
+	for (size_t side (0); side < num_sides; ++side)
+	{
+		const point& a (filter [side]);
+		const point& b (filter [(side + 1)%num_sides]);
+
+		ax [side] = a.x;
+		ay [side] = a.y;
+		dx [side] = b.x - a.x;
+		dy [side] = b.y - a.y;
+	}
+
+	// (2) Drop the inner vertices and find the hull of the
+	// remaining ones in each block
+
+	std::vector<std::vector<point>> kept (num_blocks);
+
+	parallel_for (num_blocks, num_threads,
+		[&] (unsigned block)
+		{
+			const size_t first (block*block_size);
+			const size_t last (std::min (n, first + block_size));
+			std::vector<point>& out (kept [block]);
+			size_t index (first);
+
+			if (num_sides == 0)
+			{
+				out.assign (
+					vertices.begin () + first, vertices.begin () + last);
+				index = last;
+			}
+
+#ifdef SEARCH_CPP_SSE2
+			// two vertices at a time
+
+			for (; index + 2 <= last; index += 2)
+			{
+				const __m128d
+					p (_mm_loadu_pd (&vertices [index].x)),
+					q (_mm_loadu_pd (&vertices [index + 1].x)),
+					x (_mm_unpacklo_pd (p, q)),
+					y (_mm_unpackhi_pd (p, q));
+
+				__m128d inside (_mm_cmpeq_pd (x, x));
+
+				for (size_t side (0); side < num_sides; ++side)
+				{
+					const __m128d cross (_mm_sub_pd (
+						_mm_mul_pd (_mm_set1_pd (dx [side]),
+							_mm_sub_pd (y, _mm_set1_pd (ay [side]))),
+						_mm_mul_pd (_mm_set1_pd (dy [side]),
+							_mm_sub_pd (x, _mm_set1_pd (ax [side])))));
+
+					inside = _mm_and_pd (
+						inside, _mm_cmpgt_pd (cross, _mm_setzero_pd ()));
+				}
+
+				const int mask (_mm_movemask_pd (inside));
+
+				if ((mask & 1) == 0) out.push_back (vertices [index]);
+				if ((mask & 2) == 0) out.push_back (vertices [index + 1]);
+			}
+#endif
+
+			for (; index < last; ++index)
+			{
+				const point& vertex (vertices [index]);
+				bool inside (true);
+
+				for (size_t side (0); inside && side < num_sides; ++side)
+				{
+					inside = dx [side]*(vertex.y - ay [side]) -
+						dy [side]*(vertex.x - ax [side]) > 0.0;
+				}
+
+				if (!inside) out.push_back (vertex);
+			}
+
+			// exact, so that the merge sees all the vertices
+			// the tolerance may drop
+
+			convex_polygon part;
+			part.vertices.swap (out);
+			part.hull_ok = false;
+			part.exact_hull_v = true;
+			part.convex_hull ();
+			out.swap (part.vertices);
+		});
+
+	// (3) Merge the hulls of the blocks
+
+	vertices.clear ();
+
+	for (unsigned block (0); block < num_blocks; ++block)
+	{
+		vertices.insert (
+			vertices.end (), kept [block].begin (), kept [block].end ());
+	}
+
+	hull_ok = false;
+	convex_hull ();
+}
+
+bool
+search::convex_polygon::verify_convex ()
+{
+	if (hull_ok) return true;
+
+	const size_t n (vertices.size ());
+
+	if (n < 3) return false;
+
+	// The turns at all the vertices must have the same sign and
+	// exceed the tolerance (see left_turn()), and the polygon must
+	// go round only once, i.e. the direction along the x-axis may
+	// change only twice.  The sides are checked in blocks without
+	// branches, to be vectorized.
+
+	static const size_t block_size (1024);
+
+	const double tolerance (exact_hull_v ? 0.0 : hull_tolerance);
+	double min_turn (std::numeric_limits<double>::infinity ());
+	double max_turn (-min_turn);
+
+	for (size_t first (0); first < n; first += block_size)
+	{
+		const size_t last (std::min (n, first + block_size));
+
+		for (size_t index (first); index < last; ++index)
+		{
+			const size_t
+				next (index + 1 < n ? index + 1 : 0),
+				after (next + 1 < n ? next + 1 : 0);
+			const point
+				side (vertices [next] - vertices [index]),
+				next_side (vertices [after] - vertices [next]);
+			const double
+				turn (side^next_side),
+				margin (std::max (0.0, tolerance*(side*next_side)));
+
+			min_turn = std::min (min_turn, turn - margin);
+			max_turn = std::max (max_turn, turn + margin);
+		}
+
+		if (!(min_turn > 0.0 || max_turn < 0.0)) return false;
+	}
+
+	unsigned changes (0);
+	double first_dx (0.0), last_dx (0.0);
+
+	for (size_t index (0); index < n; ++index)
+	{
+		const double dx (
+			vertices [index + 1 < n ? index + 1 : 0].x - vertices [index].x);
+
+		if (dx != 0.0)
+		{
+			if (last_dx == 0.0)
+			{
+				first_dx = dx;
+			}
+			else
+			if ((dx > 0.0) != (last_dx > 0.0))
+			{
+				++changes;
+			}
+
+			last_dx = dx;
+		}
+	}
+
+	if ((first_dx > 0.0) != (last_dx > 0.0))
+	{
+		++changes;
+	}
+
+	if (changes > 2) return false;
+
+	// clockwise, ending with the lower right point
+
+	if (min_turn > 0.0)
+	{
+		std::reverse (vertices.begin (), vertices.end ());
+	}
+
+	size_t select (0);
+
+	for (size_t index = 1; index < n; ++index)
+	{
+		const point& cur (vertices [index]), lr_point (vertices [select]);
+
+		if (cur.y < lr_point.y || (cur.y == lr_point.y && cur.x > lr_point.x))
+		{
+			select = index;
+		}
+	}
+
+	std::rotate (
+		vertices.begin (), vertices.begin () + select + 1, vertices.end ());
+
+	hull_ok = true;
+	return true;
+}
+
+double
+search::convex_polygon::compact (double tolerance)
+{
+	convex_hull ();
+
+	const size_t n (vertices.size ());
+
+	if (n < 4 || !(tolerance >= 0.0)) return 0.0;
+
+	auto vertex = [&] (size_t index) -> const point&
+	{
+		return vertices [index%n];
+	};
+
+	auto edge = [&] (size_t index)
+	{
+		return vertex (index + 1) - vertex (index);
+	};
+
+	// distance between the vertex and the line ab
+	auto error = [&] (size_t index, size_t a, size_t b)
+	{
+		return vertex (index).dist (vertex (a), vertex (b));
+	};
+
+	// start at the sharpest corner, it will certainly stay
+
+	size_t start (0);
+	double sharpest (2.0);
+
+	for (size_t index = 0; index < n; ++index)
+	{
+		const point
+			in (vertex (index) - vertex (index + n - 1)),
+			out (vertex (index + 1) - vertex (index));
+		const double cosine ((in*out)/(in.abs ()*out.abs ()));
+
+		if (cosine < sharpest)
+		{
+			sharpest = cosine;
+			start = index;
+		}
+	}
+
+	// Replace the vertices a + 1, ... , b - 1 with the side ab while
+	// the chain a, ... , b turns by less than pi/2 and the farthest
+	// of them is within tolerance.  Because of the turn, all of them
+	// project onto the side ab, so their distance to the new polygon
+	// is that to the line ab.  This distance is unimodal along the
+	// convex chain, and its maximum only moves forward as b does.
+
+	std::vector<point> kept (1, vertex (start));
+	double max_error (0.0), run_error (0.0);
+	size_t a (start), farthest (start + 1), b (start + 2);
+
+	while (b <= start + n)
+	{
+		const bool straight (edge (a)*edge (b - 1) > 0.0);
+		double e (0.0);
+
+		if (straight)
+		{
+			while (farthest + 1 < b &&
+				error (farthest + 1, a, b) >= error (farthest, a, b))
+			{
+				++farthest;
+			}
+
+			e = error (farthest, a, b);
+		}
+
+		if (straight && e <= tolerance)
+		{
+			run_error = e;
+			++b;
+		}
+		else
+		{
+			// the side ends at b - 1
+			max_error = std::max (max_error, run_error);
+			kept.push_back (vertex (b - 1));
+			a = b - 1;
+			farthest = a + 1;
+			b = a + 2;
+			run_error = 0.0;
+		}
+	}
+
+	max_error = std::max (max_error, run_error);
+
+	if (kept.size () < 3) return 0.0;
+
+	// ending with the lower right point
+
+	size_t select (0);
+
+	for (size_t index = 1; index < kept.size (); ++index)
+	{
+		const point& cur (kept [index]), lr_point (kept [select]);
+
+		if (cur.y < lr_point.y || (cur.y == lr_point.y && cur.x > lr_point.x))
+		{
+			select = index;
+		}
+	}
+
+	std::rotate (kept.begin (), kept.begin () + select + 1, kept.end ());
+	vertices.swap (kept);
+
+	return max_error;
+}
+
+bool
+search::convex_polygon::insert_vertex (const point& new_vertex)
+{
+	convex_hull ();
+
+	const size_t n (vertices.size ());
+
+	if (n < 3)
+	{
+		// a degenerate hull: calculate it again
+
+		const std::vector<point> old (vertices);
+		add_vertex (new_vertex);
+		convex_hull ();
+		return vertices != old;
+	}
+
+	// Orientation of the triangle (a, b, c): positive if it is
+	// counterclockwise.  The interior of the polygon lies on the
+	// right of its sides (the polygon is clockwise).
+	auto orientation = [] (const point& a, const point& b, const point& c)
+	{
+		return (b - a)^(c - a);
+	};
+
+	// side index goes from vertex index to vertex index + 1
+	auto outside = [&] (size_t index)
+	{
+		return orientation (
+			vertices [index], vertices [(index + 1)%n], new_vertex);
+	};
+
+	// Locate the new vertex in the fan of triangles
+	// (apex, vertices [index], vertices [index + 1]), where the apex
+	// is the last vertex, to find a side it lies outside of
+
+	const point& apex (vertices [n - 1]);
+	size_t visible (n);
+
+	if (orientation (apex, vertices [0], new_vertex) > 0.0)
+	{
+		visible = n - 1; // outside of the side (apex, vertices [0])
+	}
+	else
+	if (orientation (apex, vertices [n - 2], new_vertex) < 0.0)
+	{
+		visible = n - 2; // outside of the side (vertices [n - 2], apex)
+	}
+	else
+	{
+		// the last index with the new vertex clockwise from or on
+		// the ray (apex, vertices [index])
+		size_t low (0), high (n - 2);
+
+		while (high - low > 1)
+		{
+			const size_t middle ((low + high)/2);
+
+			if (orientation (apex, vertices [middle], new_vertex) <= 0.0)
+			{
+				low = middle;
+			}
+			else
+			{
+				high = middle;
+			}
+		}
+
+		if (outside (low) > 0.0)
+		{
+			visible = low;
+		}
+	}
+
+	if (visible == n)
+	{
+		// inside the polygon or on its boundary
+		return false;
+	}
+
+	// Find a side the new vertex lies inside of.  Going on from
+	// the visible side, the sides turn clockwise; where they have
+	// turned by pi, the polygon is extreme in the direction away
+	// from the new vertex, and one of the two sides meeting there
+	// is hidden from it.
+
+	auto side = [&] (size_t index)
+	{
+		return vertices [(index + 1)%n] - vertices [index];
+	};
+
+	const point visible_side (side (visible));
+	size_t low (1), high (n - 1);
+
+	while (high - low > 1)
+	{
+		const size_t middle ((low + high)/2);
+
+		if ((visible_side^side ((visible + middle)%n)) < 0.0)
+		{
+			low = middle;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+
+	// the hidden side is the one visible + ahead
+	size_t ahead (n);
+
+	if (outside ((visible + high)%n) < 0.0)
+	{
+		ahead = high;
+	}
+	else
+	if (outside ((visible + low)%n) < 0.0)
+	{
+		ahead = low;
+	}
+
+	// The run of the sides the new vertex lies outside of or on
+	// the line of goes from first to last.  It contains the visible
+	// side but not the hidden one, so each end is found by binary
+	// search.  The vertices between first and last are removed.
+
+	size_t first (visible), last (visible);
+
+	if (ahead < n)
+	{
+		low = 0;
+		high = ahead;
+
+		while (high - low > 1)
+		{
+			const size_t middle ((low + high)/2);
+
+			if (outside ((visible + middle)%n) >= 0.0)
+			{
+				low = middle;
+			}
+			else
+			{
+				high = middle;
+			}
+		}
+
+		last = (visible + low)%n;
+
+		low = 0;
+		high = n - ahead;
+
+		while (high - low > 1)
+		{
+			const size_t middle ((low + high)/2);
+
+			if (outside ((visible + n - middle)%n) >= 0.0)
+			{
+				low = middle;
+			}
+			else
+			{
+				high = middle;
+			}
+		}
+
+		first = (visible + n - low)%n;
+	}
+
+	const size_t count ((last + n - first)%n + 1);
+
+	// The new vertex and its neighbours must turn left by the test
+	// of convex_hull() (see left_turn()), otherwise calculate the
+	// whole hull, which drops them in the order convex_hull() does.
+	// The other vertices turn more than before.  This is also done
+	// if rounding has hidden no side.
+
+	const point&
+		before (vertices [first]),
+		after (vertices [(last + 1)%n]);
+
+	if (ahead == n ||
+		!left_turn (new_vertex, before, vertices [(first + n - 1)%n]) ||
+		!left_turn (after, new_vertex, before) ||
+		!left_turn (vertices [(last + 2)%n], after, new_vertex))
+	{
+		add_vertex (new_vertex);
+		convex_hull ();
+		return std::find (vertices.begin (), vertices.end (), new_vertex)
+			!= vertices.end ();
+	}
+
+	// keep the vertices last + 1, ... , first, then add the new one
+
+	const point lr_point (apex);
+
+	std::rotate (
+		vertices.begin (), vertices.begin () + (last + 1)%n, vertices.end ());
+	vertices.resize (n + 1 - count);
+	vertices.push_back (new_vertex);
+
+	// the lower right point must be the last one
+
+	if (!(new_vertex.y < lr_point.y ||
+		(new_vertex.y == lr_point.y && new_vertex.x > lr_point.x)))
+	{
+		std::rotate (
+			vertices.begin (),
+			std::find (vertices.begin (), vertices.end (), lr_point) + 1,
+			vertices.end ());
+	}
+
+	return true;
+}
+
+search::convex_polygon_pf::convex_polygon_pf (
+	const convex_polygon& cp)
+	: num_vertices_v (0), area_v (0.0), half_area_v (0.0),
+	  shape_v (general), rectangle_a (0.0), rectangle_b (0.0),
+	  symmetry_v (1),
+	  tmp_function (0),
+	  pf_ok (false), pf_max_ok (false), sc_ok (false),
+	  maximum_v (0.0), num_segments_v (0),
+	  num_threads_v (std::max (std::thread::hardware_concurrency (), 1u)),
+	  nodes_allocated_v (0), bytes_allocated_v (0)
+{
+	assign (cp);
+}
+
+void
+search::convex_polygon_pf::assign (const convex_polygon& cp)
+{
+	num_vertices_v = cp.num_vertices ();
+	area_v = cp.area ();
+	half_area_v = area_v / 2.0;
+	sides.assign (num_vertices_v, side ());
+	fan_areas.clear ();
+	function.clear ();
+	search_b.clear ();
+	search_pfb.clear ();
+	search_order.clear ();
+	pf_ok = pf_max_ok = sc_ok = false;
+	maximum_v = 0.0;
+	num_segments_v = 0;
+	shortest_curve = eff_perimeter ();
+
+	// fill in the array of cp sides
+
+	// since cp.convex_hull has stored the vertices in clockwise order,
+	// the sides will be stored in clockwise order, too
+
+	convex_polygon::const_iterator iter (cp.begin ());
+
+	if (num_vertices () > 2)
+	{
+		const convex_polygon::point first (*iter);
+		convex_polygon::point p (first);
+		unsigned count (0);
+
+		for (unsigned k = 1; k <= num_vertices (); ++k)
+		{
+			const convex_polygon::point q (
+				k < num_vertices () ? *++iter : first);
+
+			// no sides with (p - q).abs = 0 will be present; the
+			// following sides are moved back, leaving no gaps
+			if ((p - q).abs () != 0.0)
+			{
+				sides [count++] = side (p, q);
+			}
+
+			p = q;
+		}
+
+		num_vertices_v = count;
+		sides.resize (count);
+
+		// prefix sums for area(); the origin is moved to the first
+		// vertex to keep the partial sums of the order of area()
+
+		const convex_polygon::point origin (sides [0].p);
+		fan_areas.resize (num_vertices () + 1);
+		fan_areas [0] = 0.0;
+
+		for (unsigned k = 0; k < num_vertices (); ++k)
+		{
+			fan_areas [k + 1] = fan_areas [k] +
+				((sides [k].p - origin)^(sides [k].q - origin));
+		}
+	}
+
+	// geometry of the sides for partial_pf
+
+	side_dx.resize (num_vertices ());
+	side_dy.resize (num_vertices ());
+	side_length.resize (num_vertices ());
+	side_nx.resize (num_vertices ());
+	side_ny.resize (num_vertices ());
+	side_offset.resize (num_vertices ());
+	side_angle.resize (num_vertices ());
+
+	for (unsigned k = 0; k < num_vertices (); ++k)
+	{
+		const convex_polygon::point pq (sides [k].q - sides [k].p);
+		const double length (pq.abs ());
+
+		side_dx [k] = pq.x;
+		side_dy [k] = pq.y;
+		side_length [k] = length;
+		side_angle [k] = pq.arg ();
+
+		if (length != 0.0)
+		{
+			side_nx [k] = -pq.y/length;
+			side_ny [k] = pq.x/length;
+			side_offset [k] =
+				side_nx [k]*sides [k].p.x + side_ny [k]*sides [k].p.y;
+		}
+		else
+		{
+			side_nx [k] = side_ny [k] = side_offset [k] = 0.0;
+		}
+	}
+
+	side_boxes.resize (4*num_vertices ());
+
+	if (num_vertices () > 0)
+	{
+		build_boxes (1, 0, num_vertices ());
+	}
+
+	classify ();
+	find_symmetry ();
+}
+
+void
+search::convex_polygon_pf::classify ()
+{
+	static const double tolerance (1.0e-12);
+
+	shape_v = general;
+	rectangle_a = rectangle_b = 0.0;
+
+	if (num_vertices () == 3)
+	{
+		shape_v = triangle;
+		return;
+	}
+
+	if (num_vertices () != 4)
+	{
+		return;
+	}
+
+	// the opposite sides are equal and parallel
+
+	const double scale (std::max (side_length [0], side_length [1]));
+
+	for (unsigned k = 0; k < 2; ++k)
+	{
+		if (fabs (side_dx [k] + side_dx [k + 2]) > tolerance*scale ||
+			fabs (side_dy [k] + side_dy [k + 2]) > tolerance*scale)
+		{
+			return;
+		}
+	}
+
+	shape_v = parallelogram;
+
+	// and the adjacent ones are perpendicular
+
+	if (fabs (side_dx [0]*side_dx [1] + side_dy [0]*side_dy [1]) >
+		tolerance*side_length [0]*side_length [1])
+	{
+		return;
+	}
+
+	shape_v = rectangle;
+	rectangle_a = side_length [0];
+	rectangle_b = side_length [1];
+}
+
+void
+search::convex_polygon_pf::find_symmetry ()
+{
+	static const double tolerance (1.0e-9);
+
+	symmetry_v = 1;
+
+	const unsigned n (num_vertices ());
+
+	if (n < 3)
+	{
+		return;
+	}
+
+	// the center is the mean of the vertices, since the rotations
+	// permute them
+
+	convex_polygon::point center (0.0, 0.0);
+
+	for (unsigned k = 0; k < n; ++k)
+	{
+		center = center + sides [k].p;
+	}
+
+	center = center/n;
+
+	double radius (0.0);
+
+	for (unsigned k = 0; k < n; ++k)
+	{
+		radius = std::max (radius, (sides [k].p - center).abs ());
+	}
+
+	// the least period of the vertices under the rotation by
+	// 2*pi*period/n clockwise gives the greatest order
+
+	for (unsigned period = 1; period <= n/2; ++period)
+	{
+		if (n%period != 0)
+		{
+			continue;
+		}
+
+		const double
+			angle (-2.0*pi*period/n),
+			cos_angle (cos (angle)),
+			sin_angle (sin (angle));
+
+		bool symmetric (true);
+
+		for (unsigned k = 0; symmetric && k < n; ++k)
+		{
+			const convex_polygon::point
+				p (sides [k].p - center),
+				q (sides [(k + period)%n].p - center),
+				rotated (
+					p.x*cos_angle - p.y*sin_angle,
+					p.x*sin_angle + p.y*cos_angle);
+
+			symmetric = (rotated - q).abs () <= tolerance*radius;
+		}
+
+		if (symmetric)
+		{
+			symmetry_v = n/period;
+			return;
+		}
+	}
+}
+
+double
+search::convex_polygon_pf::pf (double z)
+{
+	static const char* const name_of_fun ("convex_polygon_pf::pf(double)");
+
+	if (is_nan (z, name_of_fun))
+	{
+		return qnan;
+	}
+
+	if (out_of_range (0.0 <= z && z <= area () && z < pos_infinity, name_of_fun))
+	{
+		return qnan;
+	}
+
+	if (shape_v == rectangle)
+	{
+		return rectangle_pf (z);
+	}
+
+	if (!pf_ok)
+	{
+		find_pf ();
+	}
+
+	if (z > half_area ())
+	{
+		z = area () - z;
+	}
+
+	return function [find_segment (z)].pf (z);
+}
+
+double
+search::convex_polygon_pf::ipf (double p)
+{
+	static const char* const name_of_fun ("convex_polygon_pf::ipf(double)");
+
+	if (is_nan (p, name_of_fun))
+	{
+		return qnan;
+	}
+
+	if (!pf_ok && shape_v != rectangle)
+	{
+		find_pf ();
+	}
+
+	if (out_of_range (0.0 <= p && p <= maximum () && p < pos_infinity, name_of_fun))
+	{
+		return qnan;
+	}
+
+	if (shape_v == rectangle)
+	{
+		return rectangle_ipf (p);
+	}
+
+	return function [find_inverse_segment (p)].ipf (p);
+}
+
+void
+search::convex_polygon_pf::pf (const double* z, size_t count, double* out)
+{
+	static const char* const name_of_fun (
+		"convex_polygon_pf::pf(const double*, size_t, double*)");
+
+	for (size_t k = 0; k < count; ++k)
+	{
+		if (!(0.0 <= z [k] && z [k] <= area ()))
+		{
+			// throws std::invalid_argument or std::out_of_range
+			if (!is_nan (z [k], name_of_fun))
+			{
+				out_of_range (false, name_of_fun);
+			}
+
+			break;
+		}
+	}
+
+	if (!pf_ok && shape_v != rectangle)
+	{
+		find_pf ();
+	}
+
+	const size_t chunk_size (4096);
+
+	parallel_for (
+		unsigned ((count + chunk_size - 1)/chunk_size), num_threads (),
+		[&] (unsigned chunk)
+		{
+			const size_t first (chunk*chunk_size);
+			pf_batch (z + first, std::min (chunk_size, count - first), out + first);
+		});
+}
+
+void
+search::convex_polygon_pf::ipf (const double* p, size_t count, double* out)
+{
+	static const char* const name_of_fun (
+		"convex_polygon_pf::ipf(const double*, size_t, double*)");
+
+	if (!pf_ok && shape_v != rectangle)
+	{
+		find_pf ();
+	}
+
+	for (size_t k = 0; k < count; ++k)
+	{
+		if (!(0.0 <= p [k] && p [k] <= maximum ()))
+		{
+			// throws std::invalid_argument or std::out_of_range
+			if (!is_nan (p [k], name_of_fun))
+			{
+				out_of_range (false, name_of_fun);
+			}
+
+			break;
+		}
+	}
+
+	const size_t chunk_size (4096);
+
+	parallel_for (
+		unsigned ((count + chunk_size - 1)/chunk_size), num_threads (),
+		[&] (unsigned chunk)
+		{
+			const size_t first (chunk*chunk_size);
+			ipf_batch (p + first, std::min (chunk_size, count - first), out + first);
+		});
+}
+
+void
+search::convex_polygon_pf::pf_batch (
+	const double* z, size_t count, double* out) const
+{
+	if (shape_v == rectangle)
+	{
+		for (size_t k = 0; k < count; ++k)
+		{
+			out [k] = 0.0 <= z [k] && z [k] <= area () ?
+				rectangle_pf (z [k]) : qnan;
+		}
+
+		return;
+	}
+
+	// sorted in either order
+	bool ascending (true), descending (true);
+
+	for (size_t k = 1; (ascending || descending) && k < count; ++k)
+	{
+		ascending = ascending && z [k - 1] <= z [k];
+		descending = descending && z [k - 1] >= z [k];
+	}
+
+	const bool sorted (ascending || descending);
+
+	// the segment of the previous argument
+	size_t index (0);
+
+	for (size_t k = 0; k < count; ++k)
+	{
+		if (!(0.0 <= z [k] && z [k] <= area ()))
+		{
+			out [k] = qnan;
+			continue;
+		}
+
+		const double w (z [k] > half_area () ? area () - z [k] : z [k]);
+
+		// the first segment with w <= b; even for sorted z,
+		// w may go up to half_area() and then back, so index
+		// moves both ways
+
+		if (sorted)
+		{
+			while (function [index].b < w)
+			{
+				++index;
+			}
+
+			while (index > 0 && function [index - 1].b >= w)
+			{
+				--index;
+			}
+		}
+		else
+		{
+			index = find_segment (w);
+		}
+
+		out [k] = function [index].pf (w);
+	}
+}
+
+void
+search::convex_polygon_pf::ipf_batch (
+	const double* p, size_t count, double* out) const
+{
+	if (shape_v == rectangle)
+	{
+		for (size_t k = 0; k < count; ++k)
+		{
+			out [k] = 0.0 <= p [k] && p [k] <= maximum_v ?
+				rectangle_ipf (p [k]) : qnan;
+		}
+
+		return;
+	}
+
+	// sorted in either order
+	bool ascending (true), descending (true);
+
+	for (size_t k = 1; (ascending || descending) && k < count; ++k)
+	{
+		ascending = ascending && p [k - 1] <= p [k];
+		descending = descending && p [k - 1] >= p [k];
+	}
+
+	const bool sorted (ascending || descending);
+
+	// the segment of the previous argument
+	size_t index (0);
+
+	for (size_t k = 0; k < count; ++k)
+	{
+		if (!(0.0 <= p [k] && p [k] <= maximum_v))
+		{
+			out [k] = qnan;
+			continue;
+		}
+
+		// the first segment with p <= pfb
+
+		if (sorted)
+		{
+			while (function [index].pfb < p [k])
+			{
+				++index;
+			}
+
+			while (index > 0 && function [index - 1].pfb >= p [k])
+			{
+				--index;
+			}
+		}
+		else
+		{
+			index = find_inverse_segment (p [k]);
+		}
+
+		out [k] = function [index].ipf (p [k]);
+	}
+}
+
+size_t
+search::convex_polygon_pf::find_segment (double z) const
+{
+	// below this size the linear search is faster
+	const size_t linear_max (16);
+
+	if (function.size () <= linear_max)
+	{
+		size_t index (0);
+
+		while (function [index].b < z && index + 1 < function.size ())
+		{
+			++index;
+		}
+
+		return index;
+	}
+
+	return search_order [eytzinger_lower_bound (search_b, z)];
+}
+
+size_t
+search::convex_polygon_pf::find_inverse_segment (double p) const
+{
+	// below this size the linear search is faster
+	const size_t linear_max (16);
+
+	if (function.size () <= linear_max)
+	{
+		size_t index (0);
+
+		while (function [index].pfb < p && index + 1 < function.size ())
+		{
+			++index;
+		}
+
+		return index;
+	}
+
+	return search_order [eytzinger_lower_bound (search_pfb, p)];
+}
+
+double
+search::convex_polygon_pf::maximum ()
+{
+	if (!pf_max_ok)
+	{
+		find_pf_max ();
+	}
+
+	return maximum_v;
+}
+
+unsigned
+search::convex_polygon_pf::num_segments ()
+{
+	if (!pf_ok)
+	{
+		find_pf ();
+	}
+
+	return num_segments_v;
+}
+
+double
+search::convex_polygon_pf::a (unsigned index)
+{
+	static const char* const name_of_fun ("convex_polygon_pf::a(unsigned)");
+
+	if (!pf_ok)
+	{
+		find_pf ();
+	}
+
+	const unsigned num_segments (this->num_segments ());
+
+	if (out_of_range (index <= num_segments, name_of_fun))
+	{
+		return qnan;
+	}
+
+	const unsigned max_index ((num_segments - 1) >> 1);
+
+	if (index <= max_index)
+	{
+		return function [index].a;
+	}
+	else
+	if (index == max_index + 1)
+	{
+		if ((num_segments & 1) == 0)
+		{
+			return half_area ();
+		}
+		else
+		{
+			return area() - function [num_segments - index].a;
+		}
+	}
+	else
+	{
+		return area() - function [num_segments - index].a;
+	}
+}
+
+double
+search::convex_polygon_pf::theta (unsigned index)
+{
+	static const char* const name_of_fun ("convex_polygon_pf::theta(unsigned)");
+
+	if (!pf_ok)
+	{
+		find_pf ();
+	}
+
+	const unsigned num_segments (this->num_segments ());
+
+	if (out_of_range (1 <= index && index <= num_segments, name_of_fun))
+	{
+		return qnan;
+	}
+
+	--index;
+
+	const unsigned max_index ((num_segments - 1) >> 1);
+
+	if (index <= max_index)
+	{
+		return function [index].theta;
+	}
+	else
+	{
+		return -function [num_segments - index - 1].theta;
+	}
+}
+
+double
+search::convex_polygon_pf::zeta (unsigned index)
+{
+	static const char* const name_of_fun ("convex_polygon_pf::zeta(unsigned)");
+
+	if (!pf_ok)
+	{
+		find_pf ();
+	}
+
+	const unsigned num_segments (this->num_segments ());
+
+	if (out_of_range (1 <= index && index <= num_segments, name_of_fun))
+	{
+		return qnan;
+	}
+
+	--index;
+
+	const unsigned max_index ((num_segments - 1) >> 1);
+
+	if (index <= max_index)
+	{
+		return function [index].zeta;
+	}
+	else
+	{
+		return -area () - function [num_segments - index - 1].zeta;
+	}
+}
+
+double
+search::convex_polygon_pf::shortest (
+	bool& is_arc, convex_polygon::point& start,
+	convex_polygon::point& end, convex_polygon::point& center)
+{
+	if (!sc_ok)
+	{
+		find_pf_max ();
+	}
+
+	if (maximum () == 0.0)
+	{
+		return 0.0;
+	}
+
+	is_arc = (shortest_curve.form == partial_pf::sqrt);
+
+	start = shortest_curve.start;
+	end = shortest_curve.end;
+
+	if (is_arc)
+	{
+		center = shortest_curve.center;
+	}
+
+	return maximum ();
+}
+
+double
+search::convex_polygon_pf::area (
+	cyclic_uint index_1, cyclic_uint index_2) const
+{
+	++index_1;
+
+	if (index_1 == index_2)
+	{
+		return 0.0;
+	}
+
+	return area (index_1, index_2, (*this) [index_1].p);
+}
+
+double
+search::convex_polygon_pf::area (
+	cyclic_uint index_1, cyclic_uint index_2,
+	const convex_polygon::point& point) const
+{
+	// the sub-polygon is point and the chain of the sides
+	// index_1 + 1, ... , index_2 - 1; the chain is taken from
+	// fan_areas and closed by the 2 triangles with the vertex
+	// at point (the shoelace formula relative to sides [0].p)
+
+	const unsigned
+		n (num_vertices ()),
+		first ((unsigned (index_1) + 1)%n),
+		count ((unsigned (index_2) + n - first)%n);
+
+	if (count == 0)
+	{
+		return 0.0;
+	}
+
+	const unsigned last ((first + count - 1)%n);
+
+	const double chain (first + count <= n ?
+		fan_areas [first + count] - fan_areas [first] :
+		fan_areas [n] - fan_areas [first] + fan_areas [first + count - n]);
+
+	const convex_polygon::point
+		origin (sides [0].p),
+		apex (point - origin);
+
+	return fabs (
+		(apex^(sides [first].p - origin)) + chain +
+		((sides [last].q - origin)^apex))/2.0;
+}
+
+void
+search::convex_polygon_pf::clip_radius (
+	cyclic_uint first, cyclic_uint last,
+	const convex_polygon::point& r, double& r_max) const
+{
+	const unsigned n (num_vertices ());
+
+	if (unsigned (first) <= unsigned (last))
+	{
+		clip_radius (1, 0, n, first, last, r, r_max);
+	}
+	else
+	{
+		clip_radius (1, 0, n, first, n, r, r_max);
+		clip_radius (1, 0, n, 0, last, r, r_max);
+	}
+}
+
+void
+search::convex_polygon_pf::clip_radius (
+	unsigned node, unsigned node_first, unsigned node_last,
+	unsigned first, unsigned last,
+	const convex_polygon::point& r, double& r_max) const
+{
+	if (last <= node_first || node_last <= first)
+	{
+		return;
+	}
+
+	// no side of the node is closer to r than its box; the
+	// tolerance covers the rounding of the distances
+
+	const box& bounds (side_boxes [node]);
+
+	const double
+		dx (std::max (std::max (bounds.min_x - r.x, r.x - bounds.max_x), 0.0)),
+		dy (std::max (std::max (bounds.min_y - r.y, r.y - bounds.max_y), 0.0));
+
+	if (dx*dx + dy*dy > r_max*r_max*(1.0 + 1.0e-9))
+	{
+		return;
+	}
+
+	if (node_last - node_first == 1)
+	{
+		const cyclic_uint index (this, node_first);
+		const double proj (this->proj (index, r));
+
+		if (0.0 < proj && proj < 1.0)
+		{
+			r_max = std::min (r_max, dist (index, r));
+		}
+
+		return;
+	}
+
+	const unsigned middle ((node_first + node_last)/2);
+
+	clip_radius (2*node, node_first, middle, first, last, r, r_max);
+	clip_radius (2*node + 1, middle, node_last, first, last, r, r_max);
+}
+
+void
+search::convex_polygon_pf::build_boxes (
+	unsigned node, unsigned node_first, unsigned node_last)
+{
+	box& bounds (side_boxes [node]);
+
+	if (node_last - node_first == 1)
+	{
+		const side& s (sides [node_first]);
+		bounds.min_x = std::min (s.p.x, s.q.x);
+		bounds.min_y = std::min (s.p.y, s.q.y);
+		bounds.max_x = std::max (s.p.x, s.q.x);
+		bounds.max_y = std::max (s.p.y, s.q.y);
+		return;
+	}
+
+	const unsigned middle ((node_first + node_last)/2);
+
+	build_boxes (2*node, node_first, middle);
+	build_boxes (2*node + 1, middle, node_last);
+
+	const box &lhs (side_boxes [2*node]), &rhs (side_boxes [2*node + 1]);
+	bounds.min_x = std::min (lhs.min_x, rhs.min_x);
+	bounds.min_y = std::min (lhs.min_y, rhs.min_y);
+	bounds.max_x = std::max (lhs.max_x, rhs.max_x);
+	bounds.max_y = std::max (lhs.max_y, rhs.max_y);
+}
+
+void
+search::convex_polygon_pf::find_pf ()
+{
+	try
+	{
+		if (num_vertices () > 2)
+		{
+			// Split the pairs of sides into blocks of consecutive
+			// index_1 with about the same number of pairs.  The
+			// blocks don't depend on the number of threads, and
+			// neither does the result.  For a symmetric polygon
+			// the first sides of the pairs run over a period only,
+			// with n/2 pairs each, see find_envelope().
+
+			const unsigned n (num_vertices ());
+			const unsigned max_blocks (128);
+			std::vector<unsigned> bounds;
+
+			if (symmetry () > 1)
+			{
+				const unsigned period (n/symmetry ());
+
+				for (unsigned block = 0; block < max_blocks; ++block)
+				{
+					const unsigned bound (period*block/max_blocks);
+
+					if (bounds.empty () || bound > bounds.back ())
+					{
+						bounds.push_back (bound);
+					}
+				}
+
+				bounds.push_back (period);
+			}
+			else
+			{
+				const double pairs_per_block (n*(n - 1.0)/2.0/max_blocks);
+				double pairs (0.0);
+
+				bounds.push_back (1); // first index_1 of the blocks
+
+				for (unsigned index = 1; index + 1 < n; ++index)
+				{
+					pairs += index;
+
+					if (pairs >= pairs_per_block*bounds.size ())
+					{
+						bounds.push_back (index + 1);
+					}
+				}
+
+				bounds.push_back (n);
+			}
+
+			// Find the envelopes of the blocks, then merge them
+			// pairwise.  Each block has its own node pool, and a
+			// merge takes the pool of its left operand, so no pool
+			// is used by 2 threads at a time.
+
+			std::vector<partial_pf_node*> envelopes (bounds.size () - 1, 0);
+
+			while (pools.size () < envelopes.size ())
+			{
+				pools.push_back (std::unique_ptr<node_pool> (new node_pool));
+			}
+
+			parallel_for (unsigned (envelopes.size ()), num_threads (),
+				[&] (unsigned block)
+				{
+					envelopes [block] = find_envelope (
+						bounds [block], bounds [block + 1], *pools [block]);
+				});
+
+			for (size_t step = 1; step < envelopes.size (); step *= 2)
+			{
+				parallel_for (
+					unsigned ((envelopes.size () + 2*step - 1)/(2*step)),
+					num_threads (),
+					[&] (unsigned merge)
+					{
+						const size_t lhs (2*step*merge), rhs (lhs + step);
+
+						if (rhs < envelopes.size ())
+						{
+							envelopes [lhs] = merge_envelopes (
+								envelopes [lhs], envelopes [rhs], *pools [lhs]);
+							envelopes [rhs] = 0;
+						}
+					});
+			}
+
+			tmp_function = envelopes [0];
+		}
+		else
+		{
+			// "stub" node in the case num_vertices < 3
+
+			if (pools.empty ())
+			{
+				pools.push_back (std::unique_ptr<node_pool> (new node_pool));
+			}
+
+			tmp_function = pools [0]->new_node (
+				partial_pf_node (0.0, half_area (), sqrt (10.0*pi*area ())));
+		}
+
+		// count the number of segments
+
+		partial_pf_node (*iter)(tmp_function);
+
+		for (; iter != 0; iter = iter->next)
+		{
+			++num_segments_v;
+		}
+
+		function.resize (num_segments_v);
+
+		for (
+			iter = tmp_function, num_segments_v = 0;
+			iter != 0;
+			iter = iter->next, ++num_segments_v)
+		{
+			function [num_segments_v] = partial_pf (*iter);
+		}
+
+		// the search layout
+
+		search_order.resize (num_segments_v + 1);
+		eytzinger_order (search_order, 1, 0);
+		search_order [0] = num_segments_v - 1;
+
+		search_b.resize (num_segments_v + 1);
+		search_pfb.resize (num_segments_v + 1);
+
+		for (size_t node = 1; node <= num_segments_v; ++node)
+		{
+			search_b [node] = function [search_order [node]].b;
+			search_pfb [node] = function [search_order [node]].pfb;
+		}
+	}
+	catch (...)
+	{
+		num_segments_v = 0;
+		function.clear ();
+		release_pools ();
+		throw;
+	}
+
+	release_pools ();
+
+	pf_ok = pf_max_ok = true;
+
+	maximum_v = function [num_segments_v - 1].pfb;
+
+	if (function [num_segments_v - 1].form == partial_pf::constant)
+	{
+		num_segments_v = num_segments_v*2 - 1;
+	}
+	else
+	{
+		num_segments_v = num_segments_v*2;
+	}
+}
+
+search::convex_polygon_pf::partial_pf_node*
+search::convex_polygon_pf::find_envelope (
+	unsigned first, unsigned last, node_pool& pool) const
+{
+	// Bottom-up merging: the stack holds the envelopes of
+	// consecutive runs of pairs, the numbers of pairs being
+	// powers of 2 decreasing toward the top.  Runs of equal size
+	// are merged, the earlier pairs always on the left.
+
+	std::vector<std::pair<partial_pf_node*, unsigned> > stack;
+
+	const unsigned n (num_vertices ());
+	const bool symmetric (symmetry () > 1);
+
+	for (unsigned row = first; row < last; ++row)
+	{
+		for (unsigned column = 0; column < (symmetric ? n/2 : row); ++column)
+		{
+			// for a symmetric polygon, the pair of the sides row and
+			// row + column + 1, in the order of the full enumeration
+			const unsigned
+				other (symmetric ? (row + column + 1)%n : column),
+				index_1 (std::max (row, other)),
+				index_2 (std::min (row, other));
+
+			// "partial" perimeter function of the two sides
+			const partial_pf ppf (
+				*this, cyclic_uint (this, index_1),
+				cyclic_uint (this, index_2));
+
+			// empty definition domain
+			if (ppf.form == partial_pf::none)
+			{
+				continue;
+			}
+
+			stack.push_back (std::make_pair (new_envelope (ppf, pool), 1u));
+
+			while (stack.size () > 1 &&
+				stack [stack.size () - 2].second == stack.back ().second)
+			{
+				partial_pf_node* merged (merge_envelopes (
+					stack [stack.size () - 2].first, stack.back ().first, pool));
+				stack.pop_back ();
+				stack.back ().first = merged;
+				stack.back ().second *= 2;
+			}
+		}
+	}
+
+	if (stack.empty ())
+	{
+		return pool.new_node (
+			partial_pf_node (0.0, half_area (), sqrt (10.0*pi*area ())));
+	}
+
+	while (stack.size () > 1)
+	{
+		partial_pf_node* merged (merge_envelopes (
+			stack [stack.size () - 2].first, stack.back ().first, pool));
+		stack.pop_back ();
+		stack.back ().first = merged;
+	}
+
+	return stack.back ().first;
+}
+
+search::convex_polygon_pf::partial_pf_node*
+search::convex_polygon_pf::new_envelope (
+	const partial_pf& ppf, node_pool& pool) const
+{
+	// fictious node to avoid handling holes in the definition domain
+	const double stub (sqrt (10.0*pi*area ()));
+	partial_pf_node* list (
+		pool.new_node (partial_pf_node (0.0, half_area (), stub)));
+
+	const double
+		a (std::max (ppf.a, 0.0)),
+		b (std::min (ppf.b, half_area ()));
+
+	// a piece with a NaN or infinite domain (from degenerate
+	// geometry) is left out: merge_envelopes() couldn't advance
+	// past its ends
+	if (!(a < b) ||
+		!(fabs (ppf.a) < pos_infinity && fabs (ppf.b) < pos_infinity &&
+		fabs (ppf.zeta) < pos_infinity))
+	{
+		return list;
+	}
+
+	partial_pf_node* iter (list);
+
+	if (a > 0.0)
+	{
+		iter->b = a;
+		iter->next = pool.new_node (*iter);
+		iter = iter->next;
+	}
+
+	*((partial_pf*)(iter)) = ppf;
+	iter->a = a;
+	iter->pfa = iter->pf (a);
+	iter->b = b;
+	iter->pfb = iter->pf (b);
+
+	if (b < half_area ())
+	{
+		iter->next = pool.new_node (partial_pf_node (b, half_area (), stub));
+	}
+
+	return list;
+}
+
+search::convex_polygon_pf::partial_pf_node*
+search::convex_polygon_pf::merge_envelopes (
+	partial_pf_node* lhs, partial_pf_node* rhs, node_pool& pool)
+{
+	partial_pf_node *result (0), *tail (0);
+
+	// the node tail has been copied from
+	const partial_pf_node* source (0);
+
+	// append the segment [left, right] of from to the result
+	auto append = [&] (const partial_pf_node* from, double left, double right)
+	{
+		if (!(left < right))
+		{
+			return;
+		}
+
+		if (from == source && tail->b == left)
+		{
+			tail->b = right;
+			tail->pfb = tail->pf (right);
+			return;
+		}
+
+		partial_pf_node* new_node (pool.new_node (*from));
+		new_node->a = left;
+		new_node->pfa = new_node->pf (left);
+		new_node->b = right;
+		new_node->pfb = new_node->pf (right);
+
+		if (tail != 0)
+		{
+			tail->next = new_node;
+		}
+		else
+		{
+			result = new_node;
+		}
+
+		tail = new_node;
+		source = from;
+	};
+
+	const partial_pf_node *x (lhs), *y (rhs);
+	double left (std::min (x->a, y->a));
+
+	// on the common segment [left, right] of 2 nodes the
+	// difference between them changes its sign at most once
+	while (x != 0 && y != 0)
+	{
+		const double right (std::min (x->b, y->b));
+
+		if (left < right)
+		{
+			double
+				delta_left (x->pf (left) - y->pf (left)),
+				delta_right (x->pf (right) - y->pf (right));
+
+			trim (delta_left);
+			trim (delta_right);
+
+			if (delta_left <= 0.0 && delta_right <= 0.0)
+			{
+				append (x, left, right);
+			}
+			else
+			if (delta_left >= 0.0 && delta_right >= 0.0)
+			{
+				append (y, left, right);
+			}
+			else
+			{
+				// a NaN root is taken as left
+				const double root (
+					std::min (right, std::max (left, x->root (*y))));
+
+				const partial_pf_node
+					*lower (delta_left < 0.0 ? x : y),
+					*upper (delta_left < 0.0 ? y : x);
+
+				append (lower, left, root);
+				append (upper, root, right);
+			}
+
+			left = right;
+		}
+
+		// written so that a NaN end advances too
+		if (!(left < x->b))
+		{
+			x = x->next;
+		}
+
+		if (!(left < y->b))
+		{
+			y = y->next;
+		}
+	}
+
+	pool.release (lhs);
+	pool.release (rhs);
+
+	return result;
+}
+
+void
+search::convex_polygon_pf::release_pools ()
+{
+	nodes_allocated_v = bytes_allocated_v = 0;
+
+	for (size_t index = 0; index < pools.size (); ++index)
+	{
+		nodes_allocated_v += pools [index]->nodes_allocated ();
+		bytes_allocated_v += pools [index]->bytes_allocated ();
+		pools [index]->release_all ();
+	}
+
+	tmp_function = 0;
+}
+
+search::convex_polygon_pf::arena::~arena ()
+{
+	while (first != 0)
+	{
+		chunk* next (first->next);
+		::operator delete (first);
+		first = next;
+	}
+}
+
+void*
+search::convex_polygon_pf::arena::allocate (size_t size)
+{
+	static const size_t
+		align (alignof (std::max_align_t)),
+		header ((sizeof (chunk) + align - 1)/align*align),
+		min_chunk (4096),
+		max_chunk (1024*1024);
+
+	size = (size + align - 1)/align*align;
+
+	if (size_t (limit - position) < size)
+	{
+		// go to the next chunk, or insert a new one if the next
+		// chunk is absent or too small
+
+		chunk* next (current != 0 ? current->next : first);
+
+		if (next == 0 || next->size < size)
+		{
+			const size_t chunk_size (std::max (size, current != 0 ?
+				std::min (2*current->size, max_chunk) : min_chunk));
+
+			chunk* new_chunk (
+				static_cast<chunk*> (::operator new (header + chunk_size)));
+			new_chunk->next = next;
+			new_chunk->size = chunk_size;
+			bytes_reserved_v += header + chunk_size;
+
+			if (current != 0)
+			{
+				current->next = new_chunk;
+			}
+			else
+			{
+				first = new_chunk;
+			}
+
+			next = new_chunk;
+		}
+
+		current = next;
+		position = reinterpret_cast<char*> (current) + header;
+		limit = position + current->size;
+	}
+
+	void* result (position);
+	position += size;
+	return result;
+}
+
+search::convex_polygon_pf::partial_pf_node*
+search::convex_polygon_pf::node_pool::new_node (const partial_pf_node& node)
+{
+	partial_pf_node* result;
+
+	if (free_list != 0)
+	{
+		result = free_list;
+		free_list = free_list->next;
+		*result = node;
+	}
+	else
+	{
+		result = new (memory.allocate (sizeof (partial_pf_node)))
+			partial_pf_node (node);
+	}
+
+	result->next = 0;
+	++nodes_allocated_v;
+	return result;
+}
+
+void
+search::convex_polygon_pf::node_pool::release (partial_pf_node* list)
+{
+	if (list == 0)
+	{
+		return;
+	}
+
+	partial_pf_node* tail (list);
+
+	while (tail->next != 0)
+	{
+		tail = tail->next;
+	}
+
+	tail->next = free_list;
+	free_list = list;
+}
+
+void
+search::convex_polygon_pf::find_pf_max ()
+{
+	if (num_vertices () < 3)
+	{
+		maximum_v = 0.0;
+		pf_max_ok = true;
+		
+		// sc_ok remains false
+
+		return;
+	}
+
+	// Rotating calipers: for every side first the pointer last
+	// runs forward over the sides index_2 for which the chain
+	// first, ... , index_2 may carry the half-area curve.
+	// When first advances, the chain only shrinks, so last never
+	// moves back, and only the pairs within the window are checked.
+
+	const unsigned n (num_vertices ());
+	std::vector<unsigned> last (n); // absolute positions, last - first < n
+
+	// for a symmetric polygon, the windows of the other sides
+	// are rotated copies of these
+	const unsigned period (n/symmetry ());
+
+	for (unsigned first = 0; first < period; ++first)
+	{
+		const cyclic_uint index_1 (this, first);
+
+		last [first] = std::max (first > 0 ? last [first - 1] : 1, first + 1);
+
+		while (last [first] + 1 < first + n &&
+			half_area_chain (index_1, cyclic_uint (this, last [first] + 1)))
+		{
+			++last [first];
+		}
+	}
+
+	// The pairs of a window are checked in two passes.  The outer
+	// area of a pair is the area of the sub-polygon p[first], ... ,
+	// q[next], the far ends of the sides included; a curve from
+	// the side first to the side next cuts off at most the outer
+	// area plus the segment between its chord and itself.  An arc
+	// of length pfb bounds a segment of at most pfb^2/(2 pi) (Dido's
+	// problem), so a pair with the outer area below half_area ()
+	// can only improve on the best pfb found so far if the missing
+	// area is within that bound.  The first pass checks the pairs
+	// whose outer area reaches half_area (), the second one only
+	// the other pairs within the bound.  The outer area grows with
+	// next and shrinks with first, so the passes begin at monotone
+	// pointers.  The pairs skipped are worse than the best one,
+	// so the result is the same as if all were checked.
+
+	auto outer_area = [&] (unsigned first, unsigned next)
+	{
+		return next + 2 < first + n ?
+			area (cyclic_uint (this, first + n - 1),
+				cyclic_uint (this, next + 1)) :
+			area ();
+	};
+
+	// the first pairs of the two passes
+	std::vector<unsigned> low (period), middle (period);
+
+	for (unsigned first = 0; first < period; ++first)
+	{
+		middle [first] = std::max (first > 0 ? middle [first - 1] : 0, first + 1);
+
+		while (middle [first] <= last [first] &&
+			outer_area (first, middle [first]) < half_area ())
+		{
+			++middle [first];
+		}
+	}
+
+	// the best pair found so far: the pair of sides
+	// (index_1, index_2) with index_1 > index_2 and the least pfb
+	struct candidate
+	{
+		double max;
+		unsigned index_1, index_2;
+		bool found;
+	};
+
+	// on a tie, the pair that comes first in the full enumeration
+	// for (index_1 = 1; ...) for (index_2 = 0; index_2 < index_1; ...)
+	// wins, so that the result doesn't depend on the order of
+	// the visit
+	auto improves = [] (
+		double max, unsigned index_1, unsigned index_2, const candidate& best)
+	{
+		return max < best.max || (best.found && max == best.max &&
+			(index_1 < best.index_1 ||
+			(index_1 == best.index_1 && index_2 < best.index_2)));
+	};
+
+	// will accumulate the maximum
+	const candidate initial = {sqrt (pi*area ()), 0, 0, false};
+
+	// Check the pairs (first, next) for from [first] <= next
+	// < to [first].  The pairs are split into chunks with about
+	// the same number of pairs.  The chunks don't depend on the
+	// number of threads, and the best pairs of the chunks are
+	// reduced in a fixed order, so the result doesn't depend on
+	// it either.
+
+	auto check = [&] (
+		const std::vector<unsigned>& from, const std::vector<unsigned>& to)
+	{
+		const unsigned max_chunks (64);
+		double pairs (0.0);
+
+		for (unsigned first = 0; first < period; ++first)
+		{
+			pairs += to [first] - from [first];
+		}
+
+		const double pairs_per_chunk (pairs/max_chunks);
+
+		std::vector<unsigned> bounds (1, 0); // first sides of the chunks
+		pairs = 0.0;
+
+		for (unsigned first = 0; first + 1 < period; ++first)
+		{
+			pairs += to [first] - from [first];
+
+			if (pairs >= pairs_per_chunk*bounds.size ())
+			{
+				bounds.push_back (first + 1);
+			}
+		}
+
+		bounds.push_back (period);
+
+		std::vector<candidate> candidates (bounds.size () - 1, initial);
+
+		parallel_for (unsigned (candidates.size ()), num_threads (),
+			[&] (unsigned chunk)
+			{
+				candidate& best (candidates [chunk]);
+
+				for (unsigned first = bounds [chunk];
+					first < bounds [chunk + 1]; ++first)
+				{
+					for (unsigned next = from [first]; next < to [first]; ++next)
+					{
+						// the pair in the order of the full enumeration
+						const unsigned next_mod (next%n);
+						const cyclic_uint
+							index_hi (this, std::max (first, next_mod)),
+							index_lo (this, std::min (first, next_mod));
+
+						// O(1) estimate of the definition domain
+						if (!partial_pf (
+							*this, index_hi, index_lo, 0, false).spans (
+							half_area ()))
+						{
+							continue;
+						}
+
+						// "partial" perimeter function of the two sides
+						const partial_pf ppf (*this, index_hi, index_lo);
+
+						// empty definition domain, or
+						// arg max outside definition domain
+						if (!ppf.spans (half_area ()))
+						{
+							continue;
+						}
+
+						if (improves (ppf.pfb, index_hi, index_lo, best))
+						{
+							best.max = ppf.pfb;
+							best.index_1 = index_hi;
+							best.index_2 = index_lo;
+							best.found = true;
+						}
+					}
+				}
+			});
+
+		candidate best (initial);
+
+		for (size_t chunk = 0; chunk < candidates.size (); ++chunk)
+		{
+			const candidate& c (candidates [chunk]);
+
+			if (c.found && improves (c.max, c.index_1, c.index_2, best))
+			{
+				best = c;
+			}
+		}
+
+		return best;
+	};
+
+	std::vector<unsigned> end (period);
+
+	for (unsigned first = 0; first < period; ++first)
+	{
+		end [first] = last [first] + 1;
+	}
+
+	candidate best (check (middle, end));
+
+	// the missing area the best pfb allows, with a relative
+	// tolerance for the rounding of the areas
+	const double allowed (best.max*best.max/(2.0*pi)*(1.0 + 1.0e-9));
+
+	for (unsigned first = 0; first < period; ++first)
+	{
+		low [first] = std::max (first > 0 ? low [first - 1] : 0, first + 1);
+
+		while (low [first] < middle [first] &&
+			half_area () - outer_area (first, low [first]) > allowed)
+		{
+			++low [first];
+		}
+	}
+
+	const candidate other (check (low, middle));
+
+	if (other.found && improves (other.max, other.index_1, other.index_2, best))
+	{
+		best = other;
+	}
+
+	// "partial" perimeter function of the two sides
+	partial_pf ppf (
+		*this, cyclic_uint (this, best.index_1),
+		cyclic_uint (this, best.index_2), &shortest_curve);
+
+	maximum_v = best.max;
+	pf_max_ok = sc_ok = true;
+}
+
+bool
+search::convex_polygon_pf::half_area_chain (
+	cyclic_uint index_1, cyclic_uint index_2) const
+{
+	// relative tolerance: the exact checks are left to partial_pf
+	const double tolerance (1.0e-9);
+
+	const convex_polygon::point
+		pq1 ((*this) [index_1].q - (*this) [index_1].p),
+		pq2 ((*this) [index_2].q - (*this) [index_2].p);
+
+	// the polygon is clockwise: the sides converge on the chain's
+	// side if the turn from pq1 to pq2 is less than pi
+	if ((pq1^pq2) > tolerance*pq1.abs ()*pq2.abs ())
+	{
+		return false;
+	}
 
-	maximum_v = max;
-	pf_max_ok = sc_ok = true;
+	return area (index_1, index_2) <= half_area ()*(1.0 + tolerance);
 }
 
 search::convex_polygon_pf::partial_pf::partial_pf (
 	const convex_polygon_pf& pf, cyclic_uint index_1,
-	cyclic_uint index_2, eff_perimeter* shortest_curve)
+	cyclic_uint index_2, eff_perimeter* shortest_curve, bool clip)
 {
 	const side side_1 (pf [index_1]), side_2 (pf [index_2]);
 	const convex_polygon::point
-	pq1 (side_1.q - side_1.p),
-	pq2 (side_2.q - side_2.p);
-	theta = convex_polygon::point (0.0, 0.0).angle (pq1, -pq2);
+	pq1 (pf.side_dx [index_1], pf.side_dy [index_1]),
+	pq2 (pf.side_dx [index_2], pf.side_dy [index_2]);
+	theta = pf.turn (index_1, index_2);
 
 	if (theta == 0.0)
 	{
 		const double
-			p2 (side_2.p.proj (side_1.p, side_1.q)),
-			q2 (side_2.q.proj (side_1.p, side_1.q));
+			p2 (pf.proj (index_1, side_2.p)),
+			q2 (pf.proj (index_1, side_2.q));
 
 		if (p2 <= 0.0 || q2 >= 1.0)
 		{
@@ -2391,7 +5381,7 @@ search::convex_polygon_pf::partial_pf::partial_pf (
 			return;
 		}
 
-		pfb = pfa = (side_1.p).dist (side_2.p, side_2.q);
+		pfb = pfa = pf.dist (index_2, side_1.p);
 		theta = 0.0;
 		zeta = pfa;
 		form = constant;
@@ -2407,8 +5397,8 @@ search::convex_polygon_pf::partial_pf::partial_pf (
 				shortest_curve->form = constant;
 
 				const convex_polygon::point
-					r1 (side_1.p + pq1 * r.proj (side_1.p, side_1.q)),
-					s1 (side_1.p + pq1 * s.proj (side_1.p, side_1.q)),
+					r1 (side_1.p + pq1 * pf.proj (index_1, r)),
+					s1 (side_1.p + pq1 * pf.proj (index_1, s)),
 					rs (s1 - r1);
 
 				const double rsa (rs.abs ());
@@ -2424,18 +5414,20 @@ search::convex_polygon_pf::partial_pf::partial_pf (
 
 					const double tp (t.proj (r1, s1));
 					shortest_curve->start = r1 + rs*tp;
-					shortest_curve->end = side_2.p + pq2*(shortest_curve->start).proj (side_2.p, side_2.q);
+					shortest_curve->end = side_2.p + pq2*pf.proj (index_2, shortest_curve->start);
 				}
 			}
 		}
 	}
 	else
 	{
+		// Intersection of the lines of the sides.  The branch below
+		// is chosen by the sign of cross, not by theta: near theta
+		// = pi, theta - pi and cross may differ in sign by rounding,
+		// and the apex must be finite on the branch taken.
+		const double cross (pq1^pq2);
 		const convex_polygon::point
-			o (0.0, 0.0),
-			r ((pq1*o.sign_area (side_2.p, side_2.q) -
-				pq2*o.sign_area (side_1.p, side_1.q))/
-				o.sign_area (pq1, pq2));
+			r ((pq1*(side_2.p^side_2.q) - pq2*(side_1.p^side_1.q))/cross);
 
 		double
 			p1 ((side_1.p - r).abs ()),
@@ -2443,7 +5435,7 @@ search::convex_polygon_pf::partial_pf::partial_pf (
 			p2 ((side_2.p - r).abs ()),
 			q2 ((side_2.q - r).abs ());
 
-		if (theta < pi) // q1p2
+		if (cross < 0.0) // q1p2, theta < pi
 		{
 			if (p1 <= p2 || q1 >= q2)
 			{
@@ -2460,17 +5452,13 @@ search::convex_polygon_pf::partial_pf::partial_pf (
 				r_min (std::max (q1, p2)),
 				r_max (std::min (p1, q2));
 
-			cyclic_uint index (index_2);
+			// the sides between the pair on the far side; if
+			// r_min >= r_max already, there is nothing to clip
 
-			for (++index; index != index_1; ++index)
+			if (clip && r_min < r_max)
 			{
-				const double proj (r.proj (pf [index].p, pf [index].q));
-
-				if (0.0 < proj && proj < 1.0)
-				{
-					r_max = std::min (
-						r_max, r.dist (pf [index].p, pf [index].q));
-				}
+				cyclic_uint index (index_2);
+				pf.clip_radius (++index, index_1, r, r_max);
 			}
 
 			if (r_min >= r_max)
@@ -2523,7 +5511,7 @@ search::convex_polygon_pf::partial_pf::partial_pf (
 			}
 		}
 		else
-		if (theta > pi) // p1q2
+		if (cross > 0.0) // p1q2, theta > pi
 		{
 			if (p1 >= p2 || q1 <= q2)
 			{
@@ -2540,17 +5528,13 @@ search::convex_polygon_pf::partial_pf::partial_pf (
 				r_min (std::max (p1, q2)),
 				r_max (std::min (q1, p2));
 
-			cyclic_uint index (index_1);
+			// the sides between the pair on the far side; if
+			// r_min >= r_max already, there is nothing to clip
 
-			for (++index; index != index_2; ++index)
+			if (clip && r_min < r_max)
 			{
-				const double proj (r.proj (pf [index].p, pf [index].q));
-
-				if (0.0 < proj && proj < 1.0)
-				{
-					r_max = std::min (
-						r_max, r.dist (pf [index].p, pf [index].q));
-				}
+				cyclic_uint index (index_1);
+				pf.clip_radius (++index, index_2, r, r_max);
 			}
 
 			if (r_min >= r_max)
@@ -2611,202 +5595,432 @@ search::convex_polygon_pf::partial_pf::partial_pf (
 	}
 }
 
-bool
-search::convex_polygon_pf::partial_pf::begin (
-	const partial_pf& ppf, double& left, double& right,
-		bool& f_left, bool& f_right)
+double
+search::convex_polygon_pf::partial_pf::root (
+	const partial_pf& ppf) const
 {
-	if (b <= ppf.a || a >= ppf.b)
-	{
-		return false;
-	}
-
-	double delta (theta - ppf.theta);
-
-	if (equal (delta, 0.0))
-	{
-		return false;
-	}
-
-	bool
-		possibly_left (a >= ppf.a),
-		possibly_right (b <= ppf.b);
-
-	const double
-		com_a (std::max (a, ppf.a)),
-		com_b (std::min (b, ppf.b)),
-		pf_com_a (pf (com_a)),
-		pf_com_b (pf (com_b)),
-		ppf_com_a (ppf.pf (com_a)),
-		ppf_com_b (ppf.pf (com_b));
-
-	double
-		delta_a (pf_com_a - ppf_com_a),
-		delta_b (pf_com_b - ppf_com_b);
-
-		trim (delta_a);
-		trim (delta_b);
-
-	if (delta_a < 0.0)
+	if (form == constant)
 	{
-		if (delta_b <= 0.0)
+		if (ppf.form == sqrt)
 		{
-			return false;
+			return (pfa/2.0)*(pfa/ppf.theta) - ppf.zeta;
 		}
 		else
 		{
-			left = root (ppf);
-			right = com_b;
-
-			if (left == right)
-			{
-				return false;
-			}
-
-			f_left = false;
-			f_right = possibly_right;
+			// ??? shouldn't be reachable
+			return std::max (a, ppf.a);
 		}
 	}
 	else
-	if (delta_a == 0.0)
 	{
-		if (delta_b <= 0.0)
+		if (ppf.form == sqrt)
 		{
-			return false;
+			if (theta == ppf.theta)
+			{
+				return std::max (a, ppf.a);
+			}
+
+			return (ppf.theta*ppf.zeta - theta*zeta)/(theta - ppf.theta);
 		}
 		else
 		{
-			left = com_a;
-			right = com_b;
-			f_left = possibly_left;
-			f_right = possibly_right;
+			return (ppf.pfa/2.0)*(ppf.pfa/theta) - zeta;
 		}
 	}
-	else // pf_com_a > ppf_om_a
+}
+
+search::perimeter_function::perimeter_function ()
+	: area_v (0.0), maximum_v (0.0), num_segments_v (1),
+	  rectangle (false), rectangle_a (0.0), rectangle_b (0.0),
+	  data (5, 0.0)
+{
+}
+
+search::perimeter_function::perimeter_function (convex_polygon_pf& pf)
+	: area_v (pf.area ()), maximum_v (0.0),
+	  num_segments_v (pf.num_segments ()),
+	  rectangle (pf.shape () == convex_polygon_pf::rectangle),
+	  rectangle_a (pf.rectangle_a), rectangle_b (pf.rectangle_b)
+{
+	maximum_v = pf.maximum ();
+
+	const size_t size (this->size ());
+	data.resize (4*size + 1);
+
+	double
+		*z_breaks (data.data ()),
+		*p_breaks (z_breaks + size + 1),
+		*thetas (p_breaks + size),
+		*zetas (thetas + size);
+
+	for (size_t index = 0; index < size; ++index)
 	{
-		if (delta_b < 0.0)
-		{
-			left = com_a;
-			right = root (ppf);
+		const convex_polygon_pf::partial_pf& ppf (pf.function [index]);
 
-			if (left == right)
-			{
-				return false;
-			}
+		z_breaks [index] = ppf.a;
+		p_breaks [index] = ppf.pfb;
 
-			f_left = possibly_left;
-			f_right = false;
+		if (ppf.form == convex_polygon_pf::partial_pf::constant)
+		{
+			thetas [index] = 0.0;
+			zetas [index] = ppf.pfa;
 		}
 		else
 		{
-			left = com_a;
-			right = com_b;
-			f_left = possibly_left;
-			f_right = possibly_right;
+			thetas [index] = ppf.theta;
+			zetas [index] = ppf.zeta;
 		}
 	}
 
-	return true;
+	z_breaks [size] = pf.function [size - 1].b;
 }
 
-bool
-search::convex_polygon_pf::partial_pf::end (
-	const partial_pf& ppf, double& right, bool& f_left)
+search::perimeter_function::perimeter_function (const convex_polygon& cp)
+{
+	convex_polygon_pf pf (cp);
+	*this = perimeter_function (pf);
+}
+
+double
+search::perimeter_function::pf (double z) const
 {
-	if (a >= ppf.b)
+	static const char* const name_of_fun ("perimeter_function::pf(double)");
+
+	if (is_nan (z, name_of_fun))
 	{
-		right = ppf.b;
-		f_left = false;
-		return true;
+		return qnan;
 	}
 
-	if (b > ppf.b && pf (ppf.b) >= ppf.pfb)
+	if (out_of_range (0.0 <= z && z <= area () && z < pos_infinity, name_of_fun))
 	{
-		right = ppf.b;
-		f_left = false;
-		return true;
+		return qnan;
 	}
 
-	bool possibly_left (a >= ppf.a);
+	if (rectangle)
+	{
+		// the same as convex_polygon_pf::rectangle_pf()
+		return pf_rectangle (
+			std::min (z, rectangle_a*rectangle_b), rectangle_a, rectangle_b);
+	}
 
-	const double
-		com_a (std::max (a, ppf.a)),
-		com_b (std::min (b, ppf.b)),
-		pf_com_a (pf (com_a)),
-		pf_com_b (pf (com_b)),
-		ppf_com_a (ppf.pf (com_a)),
-		ppf_com_b (ppf.pf (com_b));
+	if (z > area ()/2.0)
+	{
+		z = area () - z;
+	}
+
+	const size_t index (find_segment (z));
+	const double theta (thetas () [index]), zeta (zetas () [index]);
+
+	return theta == 0.0 ? zeta : sqrt (2.0*theta*(z + zeta));
+}
+
+double
+search::perimeter_function::ipf (double p) const
+{
+	static const char* const name_of_fun ("perimeter_function::ipf(double)");
 
-	if (pf_com_a > ppf_com_a)
+	if (is_nan (p, name_of_fun))
 	{
-		if (pf_com_b >= ppf_com_b)
-		{
-			right = com_b;
-			return false;
-		}
-		else
-		{
-			right = root (ppf);
-			f_left = false;
-		}
+		return qnan;
+	}
+
+	if (out_of_range (0.0 <= p && p <= maximum () && p < pos_infinity, name_of_fun))
+	{
+		return qnan;
+	}
+
+	if (rectangle)
+	{
+		// the same as convex_polygon_pf::rectangle_ipf()
+		return ipf_rectangle (
+			std::min (p, std::min (rectangle_a, rectangle_b)),
+			rectangle_a, rectangle_b);
+	}
+
+	const size_t index (find_inverse_segment (p));
+	const double theta (thetas () [index]);
+
+	return theta == 0.0 ?
+		z_breaks () [index] : (p/2.0)*(p/theta) - zetas () [index];
+}
+
+double
+search::perimeter_function::a (unsigned index) const
+{
+	static const char* const name_of_fun ("perimeter_function::a(unsigned)");
+
+	if (out_of_range (index <= num_segments (), name_of_fun))
+	{
+		return qnan;
+	}
+
+	const unsigned max_index ((num_segments () - 1) >> 1);
+
+	if (index <= max_index)
+	{
+		return z_breaks () [index];
 	}
 	else
-	if (pf_com_a == ppf_com_a)
+	if (index == max_index + 1 && (num_segments () & 1) == 0)
 	{
-		if (pf_com_b >= ppf_com_b)
-		{
-			right = com_b;
-			return false;
-		}
-		else
-		{
-			right = com_a;
-			f_left = possibly_left;
-		}
+		return area ()/2.0;
 	}
 	else
 	{
-		right = com_a;
-		f_left = possibly_left;
+		return area () - z_breaks () [num_segments () - index];
 	}
+}
 
-	return true;
+double
+search::perimeter_function::theta (unsigned index) const
+{
+	static const char* const name_of_fun ("perimeter_function::theta(unsigned)");
+
+	if (out_of_range (1 <= index && index <= num_segments (), name_of_fun))
+	{
+		return qnan;
+	}
+
+	--index;
+
+	const unsigned max_index ((num_segments () - 1) >> 1);
+
+	if (index <= max_index)
+	{
+		return thetas () [index];
+	}
+	else
+	{
+		return -thetas () [num_segments () - index - 1];
+	}
 }
 
 double
-search::convex_polygon_pf::partial_pf::root (
-	const partial_pf& ppf) const
+search::perimeter_function::zeta (unsigned index) const
 {
-	if (form == constant)
+	static const char* const name_of_fun ("perimeter_function::zeta(unsigned)");
+
+	if (out_of_range (1 <= index && index <= num_segments (), name_of_fun))
 	{
-		if (ppf.form == sqrt)
-		{
-			return (pfa/2.0)*(pfa/ppf.theta) - ppf.zeta;
-		}
-		else
+		return qnan;
+	}
+
+	--index;
+
+	const unsigned max_index ((num_segments () - 1) >> 1);
+
+	if (index <= max_index)
+	{
+		return zetas () [index];
+	}
+	else
+	{
+		return -area () - zetas () [num_segments () - index - 1];
+	}
+}
+
+size_t
+search::perimeter_function::find_segment (double z) const
+{
+	// the first segment with z <= a(index + 1)
+	const double* const b (z_breaks () + 1);
+	const size_t index (std::lower_bound (b, b + size (), z) - b);
+
+	return std::min (index, size () - 1);
+}
+
+size_t
+search::perimeter_function::find_inverse_segment (double p) const
+{
+	const double* const pfb (p_breaks ());
+	const size_t index (std::lower_bound (pfb, pfb + size (), p) - pfb);
+
+	return std::min (index, size () - 1);
+}
+
+int
+search::exact_cross_sign (long long a, long long b, long long c, long long d)
+{
+	// the products fit in 64 bits if the factors fit in 31 bits
+
+	static const long long limit (1LL << 31);
+
+	if (-limit < a && a < limit && -limit < b && b < limit &&
+		-limit < c && c < limit && -limit < d && d < limit)
+	{
+		const long long cross (a*d - b*c);
+		return (cross > 0) - (cross < 0);
+	}
+
+	// otherwise compare the 128-bit products made of 32-bit halves
+
+	auto sign = [] (long long x) { return (x > 0) - (x < 0); };
+	auto magnitude = [] (long long x)
+	{
+		return x < 0 ? 0 - (unsigned long long) x : (unsigned long long) x;
+	};
+
+	auto multiply = [] (
+		unsigned long long x, unsigned long long y,
+		unsigned long long& high, unsigned long long& low)
+	{
+		const unsigned long long
+			mask (0xFFFFFFFFULL),
+			x0 (x & mask), x1 (x >> 32), y0 (y & mask), y1 (y >> 32),
+			p00 (x0*y0), p01 (x0*y1), p10 (x1*y0), p11 (x1*y1),
+			middle ((p00 >> 32) + (p01 & mask) + (p10 & mask));
+
+		low = (middle << 32) | (p00 & mask);
+		high = p11 + (p01 >> 32) + (p10 >> 32) + (middle >> 32);
+	};
+
+	const int sign_ad (sign (a)*sign (d)), sign_bc (sign (b)*sign (c));
+
+	if (sign_ad != sign_bc)
+	{
+		return sign_ad > sign_bc ? 1 : -1;
+	}
+
+	if (sign_ad == 0)
+	{
+		return 0;
+	}
+
+	unsigned long long high_ad, low_ad, high_bc, low_bc;
+
+	multiply (magnitude (a), magnitude (d), high_ad, low_ad);
+	multiply (magnitude (b), magnitude (c), high_bc, low_bc);
+
+	const int compare (
+		high_ad != high_bc ? (high_ad > high_bc ? 1 : -1) :
+		low_ad != low_bc ? (low_ad > low_bc ? 1 : -1) : 0);
+
+	return sign_ad*compare;
+}
+
+search::convex_hull_builder::convex_hull_builder (size_t chunk_size)
+: chunk_size (std::max (chunk_size, size_t (1))), num_points_v (0)
+{
+	hull.exact_hull (true);
+}
+
+void
+search::convex_hull_builder::add_vertex (const convex_polygon::point& coord)
+{
+	++num_points_v;
+
+	// Akl-Toussaint: skip the points lying strictly inside
+	// the polygon made of the extreme vertices (clockwise)
+
+	if (!filter.empty ())
+	{
+		const size_t n (filter.size ());
+		bool inside (true);
+
+		for (size_t index (0); inside && index < n; ++index)
 		{
-			// ??? shouldn't be reachable
-			return std::max (a, ppf.a);
+			const convex_polygon::point&
+				a (filter [index]), b (filter [(index + 1)%n]);
+			inside = ((b - a)^(coord - a)) < 0.0;
 		}
+
+		if (inside) return;
 	}
-	else
+
+	collected.push_back (coord);
+
+	if (collected.size () >= chunk_size)
 	{
-		if (ppf.form == sqrt)
+		merge ();
+	}
+}
+
+const search::convex_polygon&
+search::convex_hull_builder::convex_hull ()
+{
+	merge ();
+
+	if (result.exact_hull ())
+	{
+		return hull;
+	}
+
+	result.reset ();
+	result.reserve (hull.num_vertices ());
+
+	for (auto iter (hull.begin ()); iter != hull.end (); ++iter)
+	{
+		result.add_vertex (*iter);
+	}
+
+	result.convex_hull ();
+	return result;
+}
+
+void
+search::convex_hull_builder::reset ()
+{
+	num_points_v = 0;
+	hull.reset ();
+	result.reset ();
+	collected.clear ();
+	filter.clear ();
+}
+
+void
+search::convex_hull_builder::merge ()
+{
+	if (collected.empty ()) return;
+
+	hull.add_vertices (collected.data (), collected.size ());
+	hull.convex_hull ();
+	collected.clear ();
+
+	// The extreme vertices in the directions of x, y, x + y and
+	// x - y, both ways, taken in the order of the hull
+
+	filter.clear ();
+
+	const size_t n (hull.num_vertices ());
+	if (n < 3) return;
+
+	size_t extreme [8] = {};
+	double best [8];
+	convex_polygon::const_iterator iter (hull.begin ());
+
+	for (size_t index (0); index < n; ++index, ++iter)
+	{
+		const double
+			x (iter->x), y (iter->y),
+			value [8] = { x, -x, y, -y, x + y, -x - y, x - y, y - x };
+
+		for (size_t dir (0); dir < 8; ++dir)
 		{
-			if (theta == ppf.theta)
+			if (index == 0 || value [dir] > best [dir])
 			{
-				return std::max (a, ppf.a);
+				best [dir] = value [dir];
+				extreme [dir] = index;
 			}
-
-			return (ppf.theta*ppf.zeta - theta*zeta)/(theta - ppf.theta);
 		}
-		else
+	}
+
+	std::sort (extreme, extreme + 8);
+	const size_t count (std::unique (extreme, extreme + 8) - extreme);
+
+	if (count < 3) return;
+
+	iter = hull.begin ();
+
+	for (size_t index (0), next (0); next < count; ++index, ++iter)
+	{
+		if (index == extreme [next])
 		{
-			return (ppf.pfa/2.0)*(ppf.pfa/theta) - zeta;
+			filter.push_back (*iter);
+			++next;
 		}
 	}
 }
 
-#ifdef SEARCH_CPP_THROW_RANGE
-#undef SEARCH_CPP_THROW_RANGE
-#endif
\ No newline at end of file
+#ifdef SEARCH_CPP_SSE2
+#undef SEARCH_CPP_SSE2
+#endif
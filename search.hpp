@@ -27,8 +27,11 @@
 #ifndef SEARCH_HPP
 #define SEARCH_HPP
 
+#include <algorithm>
 #include <cmath>
-#include <list>
+#include <cstddef>
+#include <limits>
+#include <memory>
 #include <stdexcept>
 #include <vector>
 
@@ -50,6 +53,39 @@ namespace search
 
 	const double pi (3.1415926535897932384626433832795);
 
+	//
+	// Checking policies deciding what the functions of sections
+	// (2) and (3) do when an argument is wrong (NaN, or a number
+	// or +/- infinity out of the specified range).  Each of them
+	// is also a template over the policy, e.g.
+	// pf_circle<nan_on_error> (z, a):
+	//
+	// throw_on_error: throw std::invalid_argument if any of the
+	// arguments is NaN, std::out_of_range if it is out of range;
+	// nan_on_error: return NaN;
+	// unchecked: no checks at all, for the callers that have
+	// validated the arguments; the result is undefined if an
+	// argument is wrong.
+	//
+	// The functions without a policy use throw_on_error.  Only
+	// those with throw_on_error may throw.
+	//
+
+	struct throw_on_error {
+		static const bool checked = true;
+		static const bool throws = true;
+	};
+
+	struct nan_on_error {
+		static const bool checked = true;
+		static const bool throws = false;
+	};
+
+	struct unchecked {
+		static const bool checked = false;
+		static const bool throws = false;
+	};
+
 	//
 	// (2) Functions calculating the gain in the area of
 	//     the residual domain in the discrete search model,
@@ -84,6 +120,35 @@ namespace search
 
 	double h (double w, double r, double a = 1.0);
 
+	//
+	// Grid versions of the functions above:
+	// out[i*num_r + j] = f(w[i], r[j]), 0 <= i < num_w,
+	// 0 <= j < num_r (a row per w), and so on.
+	//
+	// a is checked the same way as by the single version of h.
+	// The elements w[i] and r[j] are not reported one by one:
+	// out[i*num_r + j] is NaN if w[i] or r[j] is out of range
+	// (or NaN).  Returns the number of such elements of out.
+	//
+	// What depends on r only (for h, sin(r), cos(r) and the
+	// powers of r) is evaluated once for all the rows.  The rows
+	// are split among up to num_threads threads (the calling
+	// thread included).  The results are the same as those of
+	// the single versions.
+	//
+
+	size_t f (
+		const double* w, size_t num_w, const double* r, size_t num_r,
+		double* out, unsigned num_threads = 1);
+
+	size_t g (
+		const double* w, size_t num_w, const double* r, size_t num_r,
+		double* out, unsigned num_threads = 1);
+
+	size_t h (
+		const double* w, size_t num_w, const double* r, size_t num_r,
+		double* out, double a = 1.0, unsigned num_threads = 1);
+
 	//
 	// (3) Perimeter functions and inverse perimeter functions
 	//
@@ -243,6 +308,169 @@ namespace search
 
 	double pf_sphere_3d (double z, double a = 1.0);
 
+	//
+	// Versions of the functions of sections (2) and (3) above
+	// with a checking policy (see section (1))
+	//
+
+	template <typename Policy>
+	double f (double w, double r) noexcept (!Policy::throws);
+
+	template <typename Policy>
+	double g (double w, double r) noexcept (!Policy::throws);
+
+	template <typename Policy>
+	double h (double w, double r, double a = 1.0) noexcept (!Policy::throws);
+
+	template <typename Policy>
+	double pf_plane (double z) noexcept (!Policy::throws);
+
+	template <typename Policy>
+	double ipf_plane (double p) noexcept (!Policy::throws);
+
+	template <typename Policy>
+	double pf_angle (double z, double theta) noexcept (!Policy::throws);
+
+	template <typename Policy>
+	double ipf_angle (double p, double theta) noexcept (!Policy::throws);
+
+	template <typename Policy>
+	double pf_sphere (double z, double a = 1.0) noexcept (!Policy::throws);
+
+	template <typename Policy>
+	double ipf_sphere (double p, double a = 1.0) noexcept (!Policy::throws);
+
+	template <typename Policy>
+	double pf_circle (double z, double a = 1.0) noexcept (!Policy::throws);
+
+	template <typename Policy>
+	double ipf_circle (double p, double a = 1.0) noexcept (!Policy::throws);
+
+	template <typename Policy>
+	double opf_circle (double z, double a = 1.0) noexcept (!Policy::throws);
+
+	template <typename Policy>
+	double iopf_circle (double p, double a = 1.0) noexcept (!Policy::throws);
+
+	template <typename Policy>
+	double pf_rectangle (
+		double z, double a = 1.0, double b = 1.0) noexcept (!Policy::throws);
+
+	template <typename Policy>
+	double ipf_rectangle (
+		double p, double a = 1.0, double b = 1.0) noexcept (!Policy::throws);
+
+	template <typename Policy>
+	double opf_rectangle (
+		double z, double a = 1.0, double b = 1.0) noexcept (!Policy::throws);
+
+	template <typename Policy>
+	double iopf_rectangle (
+		double p, double a = 1.0, double b = 1.0) noexcept (!Policy::throws);
+
+	template <typename Policy>
+	double pf_3d (double z) noexcept (!Policy::throws);
+
+	template <typename Policy>
+	double ipf_3d (double p) noexcept (!Policy::throws);
+
+	template <typename Policy>
+	double pf_sphere_3d (double z, double a = 1.0) noexcept (!Policy::throws);
+
+	//
+	// Batch versions of the functions above:
+	// out[k] = pf_circle(z[k], a), 0 <= k < count, and so on.
+	//
+	// The arguments other than z or p are checked once, the same
+	// way as by the single versions.  The elements z[k] and p[k]
+	// are not reported one by one: out[k] is NaN for those out of
+	// range (or NaN), and in_range[k], if in_range is not null,
+	// tells which ones are valid.  Returns the number of elements
+	// out of range.
+	//
+	// The closed forms are evaluated by SSE2 if it is available.
+	//
+
+	size_t pf_plane (
+		const double* z, size_t count, double* out, bool* in_range = 0);
+
+	size_t ipf_plane (
+		const double* p, size_t count, double* out, bool* in_range = 0);
+
+	size_t pf_angle (
+		const double* z, size_t count, double* out,
+		double theta, bool* in_range = 0);
+
+	size_t ipf_angle (
+		const double* p, size_t count, double* out,
+		double theta, bool* in_range = 0);
+
+	size_t pf_sphere (
+		const double* z, size_t count, double* out,
+		double a = 1.0, bool* in_range = 0);
+
+	size_t ipf_sphere (
+		const double* p, size_t count, double* out,
+		double a = 1.0, bool* in_range = 0);
+
+	size_t pf_circle (
+		const double* z, size_t count, double* out,
+		double a = 1.0, bool* in_range = 0);
+
+	size_t ipf_circle (
+		const double* p, size_t count, double* out,
+		double a = 1.0, bool* in_range = 0);
+
+	size_t opf_circle (
+		const double* z, size_t count, double* out,
+		double a = 1.0, bool* in_range = 0);
+
+	size_t iopf_circle (
+		const double* p, size_t count, double* out,
+		double a = 1.0, bool* in_range = 0);
+
+	size_t pf_rectangle (
+		const double* z, size_t count, double* out,
+		double a = 1.0, double b = 1.0, bool* in_range = 0);
+
+	size_t ipf_rectangle (
+		const double* p, size_t count, double* out,
+		double a = 1.0, double b = 1.0, bool* in_range = 0);
+
+	size_t opf_rectangle (
+		const double* z, size_t count, double* out,
+		double a = 1.0, double b = 1.0, bool* in_range = 0);
+
+	size_t iopf_rectangle (
+		const double* p, size_t count, double* out,
+		double a = 1.0, double b = 1.0, bool* in_range = 0);
+
+	size_t pf_3d (
+		const double* z, size_t count, double* out, bool* in_range = 0);
+
+	size_t ipf_3d (
+		const double* p, size_t count, double* out, bool* in_range = 0);
+
+	size_t pf_sphere_3d (
+		const double* z, size_t count, double* out,
+		double a = 1.0, bool* in_range = 0);
+
+	//
+	// Fast versions of the circle functions above.  They are
+	// calculated with piecewise Chebyshev polynomials from tables
+	// built by the exact functions on first use; the relative
+	// error is below 1e-12.  The arguments are checked the same
+	// way as by the exact functions.
+	//
+
+	namespace fast
+	{
+		double pf_circle (double z, double a = 1.0);
+		double ipf_circle (double p, double a = 1.0);
+		double opf_circle (double z, double a = 1.0);
+		double iopf_circle (double p, double a = 1.0);
+	}
+
 	//
 	// (4) Representation of a convex polygon whose perimeter
 	//     function is to be calculated.  The clients of this
@@ -252,6 +480,8 @@ namespace search
 	//     the perimeter function.
 	//
 	
+	template <typename Int> class integer_polygon;
+
 	class convex_polygon {
 
 	public:
@@ -280,6 +510,45 @@ namespace search
 
 		void add_vertex (const point& new_vertex);
 
+		//
+		// Add count vertices at once, the same as calling
+		// add_vertex() for each of them
+		//
+
+		void add_vertices (const point* new_vertices, size_t count);
+
+		//
+		// Add the vertex to the convex polygon and replace the
+		// polygon with the new convex hull, the same as
+		// add_vertex() followed by convex_hull(), but faster.
+		// A vertex lying inside the polygon or on its boundary
+		// is found in O(log n) time and discarded.  Otherwise the
+		// two tangents from the new vertex are found by binary
+		// search in O(log n) time, the vertices between them are
+		// removed, and the stored vertices are rotated in place.
+		// Since they are kept in a vector, this shift takes O(n)
+		// time for every vertex added to the hull; it is the only
+		// step that isn't O(log n).  To add many vertices
+		// that are likely to be on the hull, add_vertices()
+		// followed by convex_hull() is faster.  If convex_hull()
+		// hasn't been called since the last add_vertex(), or
+		// the new vertex or one of its neighbours would lie on
+		// a side by the test of exact_hull(), the whole hull
+		// is calculated.
+		//
+		// Returns false if the new vertex has been discarded, that
+		// is, the polygon hasn't changed, and true otherwise.
+		//
+
+		bool insert_vertex (const point& new_vertex);
+
+		//
+		// Reserve the memory for n vertices in total, so that
+		// adding them won't reallocate the storage
+		//
+
+		void reserve (unsigned n);
+
 		//
 		// Delete all vertices from the polygon
 		//
@@ -317,6 +586,16 @@ namespace search
 		// redrawing the polygon.  convex_hull() must be called
 		// before passing the object to the convex_polygon_pf
 		// constructor, otherwise the behavior will be unpredictable.
+		//
+		// The vertices of the hull are stored clockwise, the
+		// lowest (and then the rightmost) vertex being the last
+		// one.  The duplicate vertices and the vertices lying
+		// on the sides of the hull are removed.  A vertex is
+		// taken as lying on a side if the hull turns there by
+		// less than 1e-10 radians, the working precision of
+		// equal(), see exact_hull().  The hull is found in
+		// O(n log n) time, or in O(n) time if verify_convex()
+		// succeeds.
 		// 
 		// Sample code:
 		//
@@ -335,6 +614,72 @@ namespace search
 
 		void convex_hull ();
 
+		//
+		// The same as convex_hull(), using up to num_threads
+		// threads for large polygons.  The vertices lying strictly
+		// inside the polygon made of the extreme vertices in
+		// 8 directions (Akl-Toussaint heuristic) are dropped first,
+		// then the remaining ones are split into blocks whose
+		// hulls are found in parallel and merged.  The result is
+		// the same as that of convex_hull().  There is no gain if
+		// most of the vertices lie on the hull, since the merge
+		// then sorts them all once again.
+		//
+
+		void convex_hull (unsigned num_threads);
+
+		//
+		// Choose the test by which convex_hull(), verify_convex()
+		// and insert_vertex() find the vertices lying on the
+		// sides.  By default, a vertex at which the hull turns by
+		// less than 1e-10 radians is removed.  If exact is true,
+		// a vertex is removed only if its cross product with the
+		// side is 0 in floating point, so the vertices collinear
+		// only within rounding (e.g. computed midpoints) are kept.
+		// They make num_vertices() and convex_polygon_pf::
+		// num_segments() larger, but don't change the values of
+		// the perimeter function.  The exact test depends on the
+		// rounding of the cross products, so convex_hull
+		// (unsigned), insert_vertex() and convex_hull_builder
+		// may then keep or drop such vertices unlike
+		// convex_hull().  Changing the test makes the next
+		// convex_hull() calculate the hull again.
+		//
+
+		void exact_hull (bool exact);
+		bool exact_hull () const;
+
+		//
+		// Check in O(n) time whether the vertices, in the order
+		// they have been added, make a strictly convex polygon,
+		// clockwise or counterclockwise, with no vertex lying on
+		// a side by the test of exact_hull().  If they do, store
+		// them as convex_hull() would, i.e. clockwise ending with
+		// the lowest (and then the rightmost) vertex, and return
+		// true.  Otherwise leave the vertices as they are and
+		// return false.  convex_hull() calls this function first,
+		// so the polygons read from the files that are convex
+		// already are not sorted.
+		//
+
+		bool verify_convex ();
+
+		//
+		// Remove the vertices lying within tolerance of the side
+		// that replaces them, i.e. the nearly collinear runs and
+		// the nearly coincident vertices, in O(n) time.  A run of
+		// the removed vertices turns by less than pi/2.  The
+		// convex hull is calculated first if needed.  The new
+		// polygon is convex and lies inside the old one; the
+		// returned value is the Hausdorff distance between them,
+		// not greater than tolerance.  A polygon that would be
+		// left with less than 3 vertices is not changed.  The
+		// perimeter function of the new polygon is calculated
+		// faster, since the pairs of sides to check are fewer.
+		//
+
+		double compact (double tolerance);
+
 		//
 		// Representation of a 2-dimensional point
 		//
@@ -420,10 +765,6 @@ namespace search
 			double x{}, y{};
 		};
 
-	private:
-		class vertex;
-	public:
-
 		//
 		// Bidirectional readonly iterator in the list of vertices.
 		// Clients should use this class to access the info about
@@ -443,35 +784,40 @@ namespace search
 			const_iterator& operator ++ ();
 			const_iterator& operator -- ();
 		private:
-			explicit const_iterator (std::list<vertex>::const_iterator);
-			std::list<vertex>::const_iterator iter;
+			explicit const_iterator (std::vector<point>::const_iterator);
+			std::vector<point>::const_iterator iter;
 			friend convex_polygon;
 		};
 
 	private:
 
 		//
-		// List of vertices
+		// Array of vertices
 		//
 
-		std::list<vertex> vertices;
+		std::vector<point> vertices;
 
 		//
-		// vertex = point + state.
-		// state is only used in convex_hull() in the algorithm
-		// of finding of the convex hull of the convex polygon.
+		// Flag indicating whether the vertices make the convex
+		// hull, i.e. convex_hull() has nothing to do
 		//
 
-		class vertex {
-		public:
-			vertex (const point&);
-			~vertex ();
-			enum states {unused, used, first};
-			point coord;
-			states state;
-		};
+		bool hull_ok;
+
+		//
+		// Flag set by exact_hull()
+		//
+
+		bool exact_hull_v;
+
+		//
+		// True if the chain a, b, c turns left, so that b
+		// doesn't lie on the side ac by the test of exact_hull()
+		//
+
+		bool left_turn (const point& a, const point& b, const point& c) const;
 
-		friend const_iterator;
+		template <typename Int> friend class integer_polygon;
 	};
 
 	//
@@ -480,6 +826,8 @@ namespace search
 	//     accepts a parameter of the class convex_polygon.
 	//
 
+	class perimeter_function;
+
 	class convex_polygon_pf {
 
 	public:
@@ -499,6 +847,15 @@ namespace search
 		explicit convex_polygon_pf (const convex_polygon& cp);
 		~convex_polygon_pf ();
 
+		//
+		// Replace the polygon by cp, as if the object were
+		// constructed anew.  The memory used during the
+		// calculation of the perimeter function is kept and
+		// reused.
+		//
+
+		void assign (const convex_polygon& cp);
+
 		//
 		// Info about the polygon: number of vertices, area and
 		// 1/2 of the area.
@@ -526,6 +883,23 @@ namespace search
 
 		double ipf (double p);
 
+		//
+		// Batch versions of pf() and ipf():
+		// out[k] = pf(z[k]) or out[k] = ipf(p[k]), 0 <= k < count.
+		//
+		// The arguments are checked in a single pass, and the
+		// first invalid one is reported the same way as by pf()
+		// and ipf().  If no exception is thrown, the results for
+		// the invalid arguments are NaN.
+		//
+		// Sorted arguments are evaluated in a single sweep over
+		// the segments.  Large batches are split into chunks
+		// evaluated by num_threads() threads.
+		//
+
+		void pf (const double* z, size_t count, double* out);
+		void ipf (const double* p, size_t count, double* out);
+
 		//
 		// Maximum of the perimeter function
 		//
@@ -594,6 +968,57 @@ namespace search
 			bool& is_arc, convex_polygon::point& start,
 			convex_polygon::point& end, convex_polygon::point& center);
 
+		//
+		// Number of threads used to calculate the perimeter
+		// function, its maximum and the shortest curve.  The
+		// default is the number of hardware threads.  The results
+		// don't depend on this setting.
+		//
+
+		unsigned num_threads () const;
+		void num_threads (unsigned n);
+
+		//
+		// Statistics of the last calculation of the perimeter
+		// function: the number of list nodes allocated (reused
+		// nodes included) and the number of bytes the node
+		// pools have taken from the heap.
+		//
+
+		size_t nodes_allocated () const;
+		size_t bytes_allocated () const;
+
+		//
+		// Shape of the polygon, found by the constructor and by
+		// assign() with a relative tolerance of 1e-12.  For
+		// a rectangle, whatever its rotation, pf() and ipf()
+		// use pf_rectangle() and ipf_rectangle(), so the perimeter
+		// function is only calculated if the segments are
+		// requested; maximum() and shortest() are calculated as
+		// usual, which is cheap for 4 vertices.  The library has
+		// no closed forms for the other shapes.
+		//
+
+		enum shape_type {general, triangle, parallelogram, rectangle};
+
+		shape_type shape () const;
+
+		//
+		// Order k of the rotational symmetry of the polygon
+		// (2 for the central symmetry, 1 if there is none), found
+		// by the constructor and by assign() with a relative
+		// tolerance of 1e-9.  The pairs of sides that are mapped
+		// onto each other by the rotations have the same partial
+		// perimeter functions, so only one pair of each k pairs is
+		// checked.  For a regular polygon the work is O(n) pairs
+		// rather than O(n^2).  If several shortest curves are
+		// rotated copies of each other, shortest() may return
+		// another of them than it would for a polygon without
+		// the symmetry.
+		//
+
+		unsigned symmetry () const;
+
 	private:
 
 		class partial_pf;
@@ -601,6 +1026,9 @@ namespace search
 		class cyclic_uint;
 		class side;
 		class partial_pf_node;
+		class arena;
+		class node_pool;
+		class box;
 
 		//
 		// Copying and assignment aren't supported
@@ -634,41 +1062,233 @@ namespace search
 			cyclic_uint index_1, cyclic_uint index_2,
 			const convex_polygon::point& point) const;
 
+		//
+		// Find the shape of the polygon, see shape(), and its
+		// symmetry, see symmetry()
+		//
+
+		void classify ();
+		void find_symmetry ();
+
+		//
+		// Perimeter function and inverse perimeter function
+		// of the rectangle, for the valid arguments
+		//
+
+		double rectangle_pf (double z) const;
+		double rectangle_ipf (double p) const;
+
+		//
+		// The same as point.proj((*this)[index].p, (*this)[index].q)
+		// and point.dist((*this)[index].p, (*this)[index].q), but
+		// using the precomputed geometry of the side
+		//
+
+		double proj (cyclic_uint index, const convex_polygon::point& point) const;
+		double dist (cyclic_uint index, const convex_polygon::point& point) const;
+
+		//
+		// The same as point(0, 0).angle(pq1, -pq2), where pq1 and
+		// pq2 are the directions of the sides index_1 and index_2,
+		// but using the precomputed direction angles.  Within the
+		// rounding of pi, the result may lie on the other side of
+		// pi than the angle; the sign of pq1^pq2 tells the sides.
+		//
+
+		double turn (cyclic_uint index_1, cyclic_uint index_2) const;
+
+		//
+		// Clip r_max by the distances from r to the sides
+		// first, first + 1, ... , last - 1 (cyclically) that
+		// contain the foot of the perpendicular dropped from r.
+		// The sides are looked up in the tree of bounding boxes,
+		// skipping the subtrees whose boxes are farther from r
+		// than r_max.  The second function handles the node
+		// covering the sides node_first, ... , node_last - 1.
+		//
+
+		void clip_radius (
+			cyclic_uint first, cyclic_uint last,
+			const convex_polygon::point& r, double& r_max) const;
+
+		void clip_radius (
+			unsigned node, unsigned node_first, unsigned node_last,
+			unsigned first, unsigned last,
+			const convex_polygon::point& r, double& r_max) const;
+
+		//
+		// Fill in the node of the tree of bounding boxes covering
+		// the sides node_first, ... , node_last - 1
+		//
+
+		void build_boxes (
+			unsigned node, unsigned node_first, unsigned node_last);
+
 		//
 		// Construct the perimeter function 
 		//
 
 		void find_pf ();
 
+		//
+		// Evaluate the batch of pf() or ipf() (see above) without
+		// checking the arguments; the results for the arguments
+		// out of range are NaN.  If the arguments are sorted, the
+		// segments are swept in a single pass, otherwise each
+		// segment is found by binary search.
+		//
+
+		void pf_batch (const double* z, size_t count, double* out) const;
+		void ipf_batch (const double* p, size_t count, double* out) const;
+
+		//
+		// Index of the first element of function with z <= b,
+		// and of the first one with p <= pfb.  Short functions
+		// are searched linearly, others in O(log n) using the
+		// search_* arrays.
+		//
+
+		size_t find_segment (double z) const;
+		size_t find_inverse_segment (double p) const;
+
+		//
+		// Lower envelope of the "partial" perimeter functions of
+		// the pairs of sides (index_1, index_2), where
+		// first <= index_1 < last and 0 <= index_2 < index_1,
+		// taken with the stub node over [0, half_area()].
+		// If symmetry() = k > 1, the pairs are (index, index + gap)
+		// instead, where first <= index < last <= n/k and
+		// 1 <= gap <= n/2, one of each orbit of the rotations.
+		// The pairs are merged pairwise (divide and conquer).
+		// The nodes are taken from pool.
+		//
+
+		partial_pf_node* find_envelope (
+			unsigned first, unsigned last, node_pool& pool) const;
+
+		//
+		// Envelope consisting of the stub node with ppf
+		// inserted into its definition domain
+		//
+
+		partial_pf_node* new_envelope (
+			const partial_pf& ppf, node_pool& pool) const;
+
+		//
+		// Lower envelope of 2 envelopes defined over the same
+		// domain.  Where the envelopes coincide, lhs is taken.
+		// The nodes of both lists are returned to pool.
+		//
+
+		static partial_pf_node* merge_envelopes (
+			partial_pf_node* lhs, partial_pf_node* rhs, node_pool& pool);
+
+		//
+		// Release all the node pools and update the statistics
+		//
+
+		void release_pools ();
+
 		//
 		// Find only the maximum of the perimeter function
-		// (should be a bit faster than find_pf?)
+		// and the shortest curve
 		//
 
 		void find_pf_max ();
 
+		//
+		// Returns true if the chain of the sides index_1, ... ,
+		// index_2 may carry a curve cutting off 1/2 of the area
+		// that goes from the side index_1 to the side index_2:
+		// the sides converge (or are parallel) on the chain's
+		// side, and the sub-polygon between them doesn't
+		// exceed 1/2 of the area.  Both conditions only get
+		// stronger when index_1 moves forward or index_2 moves
+		// backward along the chain.
+		//
+
+		bool half_area_chain (cyclic_uint index_1, cyclic_uint index_2) const;
+
 		//
 		// Info about the polygon: number of vertices, area,
 		// 1/2 of the area and the array of the sides.
 		//
 
 		unsigned num_vertices_v;
-		const double area_v, half_area_v;
+		double area_v, half_area_v;
+
+		//
+		// Shape of the polygon and the sides of the rectangle
+		//
+
+		shape_type shape_v;
+		double rectangle_a, rectangle_b;
+		unsigned symmetry_v;
+
 		std::vector<side> sides;
 
+		//
+		// Prefix sums of the doubled signed areas of the triangles
+		// (sides [0].p, (*this) [k].p, (*this) [k].q):
+		// fan_areas [index] is the sum over 0 <= k < index.
+		// Used by the area() member functions to find the area
+		// of any sub-polygon in O(1).
+		//
+
+		std::vector<double> fan_areas;
+
+		//
+		// Precomputed geometry of the sides, one element per side:
+		// the direction q - p, its length, the unit normal
+		// (the direction turned counterclockwise by pi/2, so that
+		// it points outward), the offset of the line of the side
+		// (normal*x = offset for any x on the line) and the
+		// direction angle in (-pi, pi].
+		// Used by partial_pf to avoid the repeated calculations
+		// for every pair of sides.
+		//
+
+		std::vector<double>
+			side_dx, side_dy, side_length,
+			side_nx, side_ny, side_offset, side_angle;
+
+		//
+		// Tree of the bounding boxes of the sides, see clip_radius():
+		// node 1 covers all the sides, and the children 2*node
+		// and 2*node + 1 cover the 2 halves of the sides of node.
+		//
+
+		std::vector<box> side_boxes;
+
 		//
 		// The structure representing the perimeter function:
 		// an array of "partial" perimeter functions
 		//
 
-		partial_pf* function;
+		std::vector<partial_pf> function;
+
+		//
+		// Copies of function[i].b and function[i].pfb in the
+		// Eytzinger layout (the order of the implicit binary
+		// search tree with the root 1 and the children 2*k and
+		// 2*k + 1 of the node k), so that the searches go
+		// through contiguous memory top down.  search_order[k]
+		// is the index in function of the node k, and
+		// search_order[0] is the index of the last element.
+		//
+
+		std::vector<double> search_b, search_pfb;
+		std::vector<unsigned> search_order;
 
 		//
 		// Temporary structure used during the calculation
-		// of the perimeter function.
+		// of the perimeter function, and the pools its nodes
+		// are taken from.  The pools are kept between the
+		// calculations.
 		//
 
 		partial_pf_node* tmp_function;
+		std::vector<std::unique_ptr<node_pool> > pools;
 
 		//
 		// Flags indicating whether the perimeter function, its
@@ -685,6 +1305,18 @@ namespace search
 		unsigned num_segments_v;
 		double maximum_v;
 
+		//
+		// Number of threads, see num_threads()
+		//
+
+		unsigned num_threads_v;
+
+		//
+		// Statistics, see nodes_allocated() and bytes_allocated()
+		//
+
+		size_t nodes_allocated_v, bytes_allocated_v;
+
 		//
 		// "Partial" perimeter function, that is, perimeter
 		// function of a pair of sides.  [a, b] is its definition
@@ -713,11 +1345,17 @@ namespace search
 			// areas could be drawn between these sides, and
 			// fills the structure pointed to by ep with the
 			// corresponding info.
+			// If clip == false, the sides lying between the pair
+			// on the far side are not checked, so the constructor
+			// runs in O(1), but b and pfb are only upper estimates:
+			// form == none or b < cp.half_area() for such an object
+			// guarantees the same for the exact one.
 			//
 
 			partial_pf (
 				const convex_polygon_pf& cp, cyclic_uint index_1,
-				cyclic_uint index_2, eff_perimeter* ep = 0);
+				cyclic_uint index_2, eff_perimeter* ep = 0,
+				bool clip = true);
 
 			~partial_pf ();
 
@@ -730,50 +1368,17 @@ namespace search
 			double ipf (double) const;
 
 			//
-			// Returns true if there exists at least one point z
-			// that belongs to the definition domains of *this
-			// and ppf for which ppf.pf(z) < this->pf(z),
-			// and false otherwise.
-			//
-			// If the return value = true, the left and right
-			// outbound variables define the segment
-			// [left, right] where ppf.pf(z) <= this->pf(z).
-			// In addition, the f_left outbound variable returns
-			// true if left = this->a, and false otherwise,
-			// and f_right returns true if right = this->b,
-			// and false otherwise.
-			//
-
-			bool begin (
-				const partial_pf& ppf, double& left, double& right,
-				bool& f_left, bool& f_right);
-
-			//
-			// Returns true
-			// (1) if there exists at least one point z
-			// that belongs to the definition domains of *this
-			// and ppf for which ppf.pf(z) > this->pf(z),
-			// or (2) if ppf.b < this->b,
-			// and false otherwise.
-			//
-			// Regardless of the return value, the right outbound
-			// variable is set to
-			// sup {z: ppf.pf(z) < this->pf(z)},
-			// where sup is taken over the intersection of the
-			// definition domains.
-			//
-			// If the return value is true, the f_left outbound
-			// variable returns true if right = this->a, and
-			// false otherwise.
+			// Find the root of the equation (*this) = ppf
 			//
 
-			bool end (const partial_pf& ppf, double& right, bool& f_left);
+			double root (const partial_pf& ppf) const;
 
 			//
-			// Find the root of the equation (*this) = ppf
+			// Returns true if the definition domain is not empty
+			// and its right boundary b is not less than z
 			//
 
-			double root (const partial_pf& ppf) const;
+			bool spans (double z) const;
 
 			enum ppf_form {constant, sqrt, none};
 			ppf_form form{};
@@ -834,23 +1439,353 @@ namespace search
 			convex_polygon::point p, q;
 		};
 
+		//
+		// Bounding box of a set of points
+		//
+
+		class box {
+		public:
+			double min_x, min_y, max_x, max_y;
+		};
+
 		//
 		// List node:
-		// partial_pf_node = partial_pf + next
+		// partial_pf_node = partial_pf + next.
+		// The nodes are placed in a node_pool and are never
+		// destroyed one by one.
 		//
 
 		class partial_pf_node : public partial_pf {
 		public:
 			partial_pf_node (double, double, double);
-			~partial_pf_node ();
 			partial_pf_node* next;
 		};
+
+		//
+		// Monotonic memory arena.  The memory is taken from the
+		// heap in chunks of growing size and is only returned
+		// by the destructor.  release() makes all the chunks
+		// available again at once, without visiting the objects
+		// placed in them.
+		//
+
+		class arena {
+		public:
+			arena ();
+			~arena ();
+			void* allocate (size_t size);
+			void release ();
+			size_t bytes_reserved () const;
+		private:
+			arena (const arena&);
+			arena& operator = (const arena&);
+			struct chunk {
+				chunk* next;
+				size_t size;
+			};
+			chunk *first, *current;
+			char *position, *limit;
+			size_t bytes_reserved_v;
+		};
+
+		//
+		// Pool of list nodes placed in an arena.  The released
+		// nodes are kept in a free list and reused.
+		// release_all() forgets all the nodes at once.
+		//
+
+		class node_pool {
+		public:
+			node_pool ();
+			~node_pool ();
+			partial_pf_node* new_node (const partial_pf_node& node);
+			void release (partial_pf_node* list);
+			void release_all ();
+			size_t nodes_allocated () const;
+			size_t bytes_allocated () const;
+		private:
+			arena memory;
+			partial_pf_node* free_list;
+			size_t nodes_allocated_v;
+		};
 		friend partial_pf;
 		friend partial_pf_node;
+		friend perimeter_function;
 	};
 
 	//
-	// Inline functions
+	// (6) Finished perimeter function of a convex polygon.
+	//     An immutable value taken from convex_polygon_pf that
+	//     keeps only the breakpoints and the parameters of the
+	//     segments in a single contiguous array (a vector of
+	//     double with the default alignment), so the objects
+	//     are small and cheap to copy.  The member functions
+	//     have the same meaning and ranges as those of
+	//     convex_polygon_pf, and return the same values:  for
+	//     a rectangle, pf() and ipf() use the closed forms
+	//     pf_rectangle() and ipf_rectangle() as well.
+	//
+
+	class perimeter_function {
+
+	public:
+
+		//
+		// Constructors.  The default constructor creates the
+		// perimeter function of the empty polygon.  The other
+		// ones calculate the perimeter function if needed; the
+		// requirements for cp are those of convex_polygon_pf.
+		//
+
+		perimeter_function ();
+		explicit perimeter_function (convex_polygon_pf& pf);
+		explicit perimeter_function (const convex_polygon& cp);
+
+		//
+		// Area of the polygon
+		//
+
+		double area () const;
+
+		//
+		// Perimeter function and inverse perimeter function
+		//
+
+		double operator () (double z) const;
+		double pf (double z) const;
+		double ipf (double p) const;
+
+		//
+		// Maximum, number of smooth segments and parameters
+		// of the segments
+		//
+
+		double maximum () const;
+		unsigned num_segments () const;
+		double a (unsigned i) const;
+		double theta (unsigned i) const;
+		double zeta (unsigned i) const;
+
+	private:
+
+		//
+		// Number of the stored segments 1, ... , size(); the
+		// others are symmetric to them
+		//
+
+		size_t size () const;
+
+		//
+		// Index of the first stored segment with z <= a(index + 1),
+		// and of the first one whose value at a(index + 1) is not
+		// less than p
+		//
+
+		size_t find_segment (double z) const;
+		size_t find_inverse_segment (double p) const;
+
+		//
+		// The arrays stored one after another in data:
+		// z_breaks()[0 .. size()]: a(0), ... , a(size()),
+		// p_breaks()[0 .. size() - 1]: the values of the function
+		// at a(1), ... , a(size()),
+		// thetas()[0 .. size() - 1], zetas()[0 .. size() - 1]:
+		// the parameters of the segments; theta is 0 and zeta is
+		// the value of the function for the constant segment.
+		//
+
+		const double* z_breaks () const;
+		const double* p_breaks () const;
+		const double* thetas () const;
+		const double* zetas () const;
+
+		double area_v, maximum_v;
+		unsigned num_segments_v;
+
+		//
+		// Sides of the polygon if it is a rectangle,
+		// see convex_polygon_pf::shape()
+		//
+
+		bool rectangle;
+		double rectangle_a, rectangle_b;
+
+		std::vector<double> data;
+	};
+
+	//
+	// (7) Convex hull of a stream of points.  The points are
+	//     consumed one by one; the memory used is proportional
+	//     to the number of the vertices of the hull plus the
+	//     chunk size rather than to the number of the points.
+	//     A point lying strictly inside the polygon made of the
+	//     extreme vertices of the current hull in 8 directions
+	//     (Akl-Toussaint heuristic) is discarded at once.  The
+	//     other ones are collected and merged into the hull when
+	//     chunk_size of them have been collected.
+	//
+
+	class convex_hull_builder {
+
+	public:
+
+		explicit convex_hull_builder (size_t chunk_size = 65536);
+
+		//
+		// Add a point
+		//
+
+		void add_vertex (const convex_polygon::point& coord);
+
+		//
+		// Number of the points added, including the discarded ones
+		//
+
+		size_t num_points () const;
+
+		//
+		// Convex hull of all the points added so far, the same
+		// as the result of convex_polygon::convex_hull()
+		//
+
+		const convex_polygon& convex_hull ();
+
+		//
+		// The same as convex_polygon::exact_hull()
+		//
+
+		void exact_hull (bool exact);
+		bool exact_hull () const;
+
+		//
+		// Remove all the points
+		//
+
+		void reset ();
+
+	private:
+
+		//
+		// Merge the collected points into the hull and take
+		// the extreme vertices for the filter
+		//
+
+		void merge ();
+
+		size_t chunk_size;
+		size_t num_points_v;
+
+		//
+		// The hull of the chunks merged so far is kept with the
+		// exact test, so that no vertex is lost to the tolerance
+		// before the points near it are seen.  result holds the
+		// hull returned by convex_hull() if the test isn't exact.
+		//
+
+		convex_polygon hull, result;
+		std::vector<convex_polygon::point> collected;
+
+		//
+		// Extreme vertices of the hull, clockwise; empty if
+		// they don't make a polygon
+		//
+
+		std::vector<convex_polygon::point> filter;
+	};
+
+	//
+	// (8) Polygon with integer coordinates.  Int is an integer
+	//     type of at most 32 bits.  The convex hull is found with
+	//     exact orientation tests, so the collinear and the
+	//     duplicate vertices are removed exactly.  The hull is
+	//     stored in the same order as by convex_polygon and is
+	//     converted to double coordinates only once, by get().
+	//
+
+	//
+	// Sign of a*d - b*c calculated exactly for
+	// |a|, |b|, |c|, |d| < 2^63
+	//
+
+	int exact_cross_sign (long long a, long long b, long long c, long long d);
+
+	//
+	// Andrew's monotone chain shared by convex_polygon and
+	// integer_polygon: replace the points with their convex hull,
+	// stored clockwise ending with the lower right point.
+	// keep (a, b, c) is true if the chain a, b, c turns left
+	// so that b remains a vertex.
+	//
+
+	template <typename Point, typename Keep>
+	void monotone_chain (std::vector<Point>& points, Keep keep);
+
+	template <typename Int>
+	class integer_polygon {
+
+	public:
+
+		//
+		// Representation of a 2-dimensional point
+		//
+
+		struct point {
+
+			point ();
+			point (Int x, Int y);
+			bool operator == (const point&) const;
+			bool operator != (const point&) const;
+
+			Int x, y;
+		};
+
+		typedef typename std::vector<point>::const_iterator const_iterator;
+
+		//
+		// The same as the member functions of convex_polygon
+		//
+
+		integer_polygon ();
+		void add_vertex (const point& new_vertex);
+		void reserve (unsigned n);
+		void reset ();
+		const_iterator begin () const;
+		const_iterator end () const;
+		unsigned num_vertices () const;
+
+		//
+		// Replace the polygon with its convex hull, see
+		// convex_polygon::convex_hull()
+		//
+
+		void convex_hull ();
+
+		//
+		// Replace the contents of cp with the polygon.  If
+		// convex_hull() has been called, cp needn't call it
+		// again before being passed to convex_polygon_pf.
+		//
+
+		void get (convex_polygon& cp) const;
+
+	private:
+
+		//
+		// Sign of the orientation of the triangle (a, b, c):
+		// positive if it is counterclockwise
+		//
+
+		static int orientation (const point& a, const point& b, const point& c);
+
+		std::vector<point> vertices;
+		bool hull_ok;
+
+		static_assert (std::numeric_limits<Int>::is_integer &&
+			sizeof (Int) <= 4, "Int must be an integer of at most 32 bits");
+	};
+
+	//
+	// Inline functions
 	//
 
 	inline bool
@@ -871,12 +1806,14 @@ namespace search
 
 	inline
 	convex_polygon::convex_polygon ()
+	: hull_ok (true), exact_hull_v (false)
 	{
 	}
 
 	inline
 	convex_polygon::convex_polygon (const convex_polygon& rhs)
-	: vertices (rhs.vertices)
+	: vertices (rhs.vertices), hull_ok (rhs.hull_ok),
+	  exact_hull_v (rhs.exact_hull_v)
 	{
 	}
 
@@ -894,19 +1831,49 @@ namespace search
 		}
 
 		vertices = rhs.vertices;
+		hull_ok = rhs.hull_ok;
+		exact_hull_v = rhs.exact_hull_v;
 		return *this;
 	}
 
 	inline void
 	convex_polygon::add_vertex (const point& coord)
 	{
-		vertices.push_back (vertex (coord));
+		vertices.push_back (coord);
+		hull_ok = false;
+	}
+
+	inline void
+	convex_polygon::add_vertices (const point* new_vertices, size_t count)
+	{
+		vertices.insert (vertices.end (), new_vertices, new_vertices + count);
+		hull_ok = hull_ok && count == 0;
+	}
+
+	inline void
+	convex_polygon::exact_hull (bool exact)
+	{
+		hull_ok = hull_ok && exact == exact_hull_v;
+		exact_hull_v = exact;
+	}
+
+	inline bool
+	convex_polygon::exact_hull () const
+	{
+		return exact_hull_v;
+	}
+
+	inline void
+	convex_polygon::reserve (unsigned n)
+	{
+		vertices.reserve (n);
 	}
 
 	inline void
 	convex_polygon::reset ()
 	{
 		vertices.clear ();
+		hull_ok = true;
 	}
 
 	inline convex_polygon::const_iterator
@@ -949,7 +1916,7 @@ namespace search
 	inline bool
 	convex_polygon::point::operator != (const point& p) const
 	{
-		return (x != p.x || y == p.y);
+		return !(*this == p);
 	}
 
 	inline convex_polygon::point
@@ -1103,13 +2070,13 @@ namespace search
 	inline convex_polygon::point
 	convex_polygon::const_iterator::operator * () const
 	{
-		return iter->coord;
+		return *iter;
 	}
 
 	inline const convex_polygon::point*
 	convex_polygon::const_iterator::operator -> () const
 	{
-		return &iter->coord;
+		return &*iter;
 	}
 
 	inline bool
@@ -1139,26 +2106,14 @@ namespace search
 	}
 
 	inline convex_polygon::const_iterator::const_iterator (
-		std::list<convex_polygon::vertex>::const_iterator iter)
+		std::vector<convex_polygon::point>::const_iterator iter)
 	: iter (iter)
 	{
 	}
 
-	inline
-	convex_polygon::vertex::vertex (const point& coord)
-	: coord (coord), state (unused)
-	{
-	}
-
-	inline
-	convex_polygon::vertex::~vertex ()
-	{
-	}
-
 	inline
 	convex_polygon_pf::~convex_polygon_pf ()
 	{
-		delete [] function;
 	}
 
 	inline unsigned
@@ -1185,6 +2140,111 @@ namespace search
 		return pf (z);
 	}
 
+	inline unsigned
+	convex_polygon_pf::num_threads () const
+	{
+		return num_threads_v;
+	}
+
+	inline void
+	convex_polygon_pf::num_threads (unsigned n)
+	{
+		num_threads_v = n > 0 ? n : 1;
+	}
+
+	inline convex_polygon_pf::shape_type
+	convex_polygon_pf::shape () const
+	{
+		return shape_v;
+	}
+
+	inline unsigned
+	convex_polygon_pf::symmetry () const
+	{
+		return symmetry_v;
+	}
+
+	inline double
+	convex_polygon_pf::rectangle_pf (double z) const
+	{
+		// area() may differ from a*b in the last bits
+		return pf_rectangle (
+			std::min (z, rectangle_a*rectangle_b), rectangle_a, rectangle_b);
+	}
+
+	inline double
+	convex_polygon_pf::rectangle_ipf (double p) const
+	{
+		return ipf_rectangle (
+			std::min (p, std::min (rectangle_a, rectangle_b)),
+			rectangle_a, rectangle_b);
+	}
+
+	inline double
+	convex_polygon_pf::proj (
+		cyclic_uint index, const convex_polygon::point& point) const
+	{
+		const double length (side_length [index]);
+
+		if (length == 0.0)
+		{
+			return (point - sides [index].p).abs ();
+		}
+
+		return ((point.x - sides [index].p.x)*side_dx [index] +
+			(point.y - sides [index].p.y)*side_dy [index])/length/length;
+	}
+
+	inline double
+	convex_polygon_pf::dist (
+		cyclic_uint index, const convex_polygon::point& point) const
+	{
+		if (side_length [index] == 0.0)
+		{
+			return (point - sides [index].p).abs ();
+		}
+
+		return fabs (
+			side_nx [index]*point.x + side_ny [index]*point.y - side_offset [index]);
+	}
+
+	inline double
+	convex_polygon_pf::turn (cyclic_uint index_1, cyclic_uint index_2) const
+	{
+		// the direction of -pq2 differs from that of pq2 by pi
+		double angle (side_angle [index_2] - side_angle [index_1] + pi);
+
+		if (angle < 0.0)
+		{
+			angle += 2.0*pi;
+		}
+		else
+		if (angle >= 2.0*pi)
+		{
+			angle -= 2.0*pi;
+		}
+
+		// angle() trims its result and maps it into [0, 2*pi)
+		if (equal (angle, 0.0) || equal (angle, 2.0*pi))
+		{
+			angle = 0.0;
+		}
+
+		return angle;
+	}
+
+	inline size_t
+	convex_polygon_pf::nodes_allocated () const
+	{
+		return nodes_allocated_v;
+	}
+
+	inline size_t
+	convex_polygon_pf::bytes_allocated () const
+	{
+		return bytes_allocated_v;
+	}
+
 	inline convex_polygon_pf::side&
 	convex_polygon_pf::operator [] (cyclic_uint index)
 	{
@@ -1234,6 +2294,12 @@ namespace search
 		return form == constant ? a : (p/2.0)*(p/theta) - zeta;
 	}
 
+	inline bool
+	convex_polygon_pf::partial_pf::spans (double z) const
+	{
+		return form != none && b >= z;
+	}
+
 	inline
 	convex_polygon_pf::cyclic_uint::cyclic_uint (
 		const convex_polygon_pf* cppf, unsigned uint)
@@ -1309,11 +2375,332 @@ namespace search
 	}
 
 	inline
-	convex_polygon_pf::partial_pf_node::~partial_pf_node ()
+	convex_polygon_pf::arena::arena ()
+	: first (0), current (0), position (0), limit (0), bytes_reserved_v (0)
+	{
+	}
+
+	inline void
+	convex_polygon_pf::arena::release ()
+	{
+		current = 0;
+		position = limit = 0;
+	}
+
+	inline size_t
+	convex_polygon_pf::arena::bytes_reserved () const
+	{
+		return bytes_reserved_v;
+	}
+
+	inline
+	convex_polygon_pf::node_pool::node_pool ()
+	: free_list (0), nodes_allocated_v (0)
+	{
+	}
+
+	inline
+	convex_polygon_pf::node_pool::~node_pool ()
+	{
+	}
+
+	inline void
+	convex_polygon_pf::node_pool::release_all ()
+	{
+		memory.release ();
+		free_list = 0;
+		nodes_allocated_v = 0;
+	}
+
+	inline size_t
+	convex_polygon_pf::node_pool::nodes_allocated () const
+	{
+		return nodes_allocated_v;
+	}
+
+	inline size_t
+	convex_polygon_pf::node_pool::bytes_allocated () const
+	{
+		return memory.bytes_reserved ();
+	}
+
+	inline double
+	perimeter_function::area () const
+	{
+		return area_v;
+	}
+
+	inline double
+	perimeter_function::operator () (double z) const
+	{
+		return pf (z);
+	}
+
+	inline double
+	perimeter_function::maximum () const
+	{
+		return maximum_v;
+	}
+
+	inline unsigned
+	perimeter_function::num_segments () const
+	{
+		return num_segments_v;
+	}
+
+	inline size_t
+	perimeter_function::size () const
+	{
+		return (num_segments_v + 1)/2;
+	}
+
+	inline const double*
+	perimeter_function::z_breaks () const
+	{
+		return data.data ();
+	}
+
+	inline const double*
+	perimeter_function::p_breaks () const
+	{
+		return data.data () + size () + 1;
+	}
+
+	inline const double*
+	perimeter_function::thetas () const
+	{
+		return data.data () + 2*size () + 1;
+	}
+
+	inline const double*
+	perimeter_function::zetas () const
+	{
+		return data.data () + 3*size () + 1;
+	}
+
+	inline size_t
+	convex_hull_builder::num_points () const
+	{
+		return num_points_v;
+	}
+
+	inline void
+	convex_hull_builder::exact_hull (bool exact)
+	{
+		result.exact_hull (exact);
+	}
+
+	inline bool
+	convex_hull_builder::exact_hull () const
+	{
+		return result.exact_hull ();
+	}
+
+	//
+	// Template functions
+	//
+
+	template <typename Point, typename Keep> void
+	monotone_chain (std::vector<Point>& points, Keep keep)
+	{
+		// sort the points by x, then by y, and build the lower and
+		// the upper hulls counterclockwise.  The points at which the
+		// chain doesn't turn left are dropped, so are the duplicates.
+
+		std::sort (points.begin (), points.end (),
+			[] (const Point& lhs, const Point& rhs)
+			{
+				return lhs.x < rhs.x || (lhs.x == rhs.x && lhs.y < rhs.y);
+			});
+
+		points.erase (
+			std::unique (points.begin (), points.end ()), points.end ());
+
+		const size_t n (points.size ());
+
+		if (n == 1)
+		{
+			return;
+		}
+
+		std::vector<Point> hull (2*n); // will hold the convex hull
+		size_t size (0);
+
+		for (size_t index = 0; index < n; ++index)
+		{
+			while (size >= 2 &&
+				!keep (hull [size - 2], hull [size - 1], points [index]))
+			{
+				--size;
+			}
+
+			hull [size++] = points [index];
+		}
+
+		const size_t rightmost (size - 1);
+
+		for (size_t index = n - 1, lower (size + 1); index-- > 0; )
+		{
+			while (size >= lower &&
+				!keep (hull [size - 2], hull [size - 1], points [index]))
+			{
+				--size;
+			}
+
+			hull [size++] = points [index];
+		}
+
+		// the first point has been added twice
+		hull.resize (size - 1);
+
+		// the leftmost and the rightmost points end the chains,
+		// so keep() hasn't been checked at them
+
+		if (hull.size () >= 3 && !keep (hull [rightmost - 1],
+			hull [rightmost], hull [(rightmost + 1)%hull.size ()]))
+		{
+			hull.erase (hull.begin () + rightmost);
+		}
+
+		if (hull.size () >= 3 && !keep (hull.back (), hull [0], hull [1]))
+		{
+			hull.erase (hull.begin ());
+		}
+
+		// find the lower right point
+
+		size_t select (0);
+
+		for (size_t index = 1; index < hull.size (); ++index)
+		{
+			const Point& cur (hull [index]), lr_point (hull [select]);
+
+			if (cur.y < lr_point.y || (cur.y == lr_point.y && cur.x > lr_point.x))
+			{
+				select = index;
+			}
+		}
+
+		// store the points clockwise ending with the lower right point
+
+		std::rotate (hull.begin (), hull.begin () + select, hull.end ());
+		std::reverse (hull.begin (), hull.end ());
+		points.swap (hull);
+	}
+
+	template <typename Int>
+	integer_polygon<Int>::point::point ()
+	: x (0), y (0)
+	{
+	}
+
+	template <typename Int>
+	integer_polygon<Int>::point::point (Int x, Int y)
+	: x (x), y (y)
+	{
+	}
+
+	template <typename Int> bool
+	integer_polygon<Int>::point::operator == (const point& rhs) const
+	{
+		return x == rhs.x && y == rhs.y;
+	}
+
+	template <typename Int> bool
+	integer_polygon<Int>::point::operator != (const point& rhs) const
+	{
+		return !(*this == rhs);
+	}
+
+	template <typename Int>
+	integer_polygon<Int>::integer_polygon ()
+	: hull_ok (true)
+	{
+	}
+
+	template <typename Int> void
+	integer_polygon<Int>::add_vertex (const point& new_vertex)
+	{
+		vertices.push_back (new_vertex);
+		hull_ok = false;
+	}
+
+	template <typename Int> void
+	integer_polygon<Int>::reserve (unsigned n)
+	{
+		vertices.reserve (n);
+	}
+
+	template <typename Int> void
+	integer_polygon<Int>::reset ()
+	{
+		vertices.clear ();
+		hull_ok = true;
+	}
+
+	template <typename Int> typename integer_polygon<Int>::const_iterator
+	integer_polygon<Int>::begin () const
 	{
-		delete next;
+		return vertices.begin ();
+	}
+
+	template <typename Int> typename integer_polygon<Int>::const_iterator
+	integer_polygon<Int>::end () const
+	{
+		return vertices.end ();
+	}
+
+	template <typename Int> unsigned
+	integer_polygon<Int>::num_vertices () const
+	{
+		return unsigned (vertices.size ());
+	}
+
+	template <typename Int> int
+	integer_polygon<Int>::orientation (
+		const point& a, const point& b, const point& c)
+	{
+		const long long
+			bx ((long long) b.x - a.x), by ((long long) b.y - a.y),
+			cx ((long long) c.x - a.x), cy ((long long) c.y - a.y);
+
+		return exact_cross_sign (bx, by, cx, cy);
+	}
+
+	template <typename Int> void
+	integer_polygon<Int>::convex_hull ()
+	{
+		if (hull_ok) return; // nothing to do
+
+		hull_ok = true;
+
+		if (num_vertices () < 3) return; // nothing to do
+
+		// the orientation test is exact, so are the collinear
+		// vertices dropped
+
+		monotone_chain (vertices,
+			[] (const point& a, const point& b, const point& c)
+			{
+				return orientation (a, b, c) > 0;
+			});
+	}
+
+	template <typename Int> void
+	integer_polygon<Int>::get (convex_polygon& cp) const
+	{
+		cp.vertices.clear ();
+		cp.vertices.reserve (vertices.size ());
+
+		for (const point& vertex : vertices)
+		{
+			cp.vertices.push_back (
+				convex_polygon::point (double (vertex.x), double (vertex.y)));
+		}
+
+		cp.hull_ok = hull_ok;
 	}
 
 } // namespace search
 
-#endif // SEARCH_HPP
\ No newline at end of file
+#endif // SEARCH_HPP
@@ -0,0 +1,167 @@
+//
+// compact_test.cpp:
+// Randomized test of convex_polygon::compact().  For random
+// convex hulls, including the thin ones where the removed runs
+// are long, checks that every vertex of the old polygon lies
+// within the returned bound, and within tolerance, of the new
+// polygon.  The distance is calculated by brute force.
+//
+// Not a part of the Visual Studio project; build from the
+// repository root, e.g. with MSVC
+//
+//	cl /EHsc /O2 /I. test\compact_test.cpp search.cpp
+//
+// or with g++, which lacks _isnan
+//
+//	g++ -std=c++14 -O2 -pthread -D_isnan=std::isnan -I.
+//		test/compact_test.cpp search.cpp
+//
+// Returns 0 if all the cases pass.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "search.hpp"
+
+typedef search::convex_polygon::point point;
+
+static std::vector<point> vertices (const search::convex_polygon& cp)
+{
+	std::vector<point> result;
+	for (auto it (cp.begin ()); it != cp.end (); ++it)
+	{
+		result.push_back (*it);
+	}
+	return result;
+}
+
+//
+// Distance between v and the segment pq
+//
+
+static double segment_dist (const point& v, const point& p, const point& q)
+{
+	const double t (v.proj (p, q));
+	if (t <= 0.0) return (v - p).abs ();
+	if (t >= 1.0) return (v - q).abs ();
+	return v.dist (p, q);
+}
+
+//
+// Distance between v and the convex polygon,
+// 0 if v lies inside
+//
+
+static double polygon_dist (const point& v, const std::vector<point>& polygon)
+{
+	const size_t n (polygon.size ());
+	double orientation (0.0);
+	for (size_t i (0); i < n; ++i)
+	{
+		orientation += polygon [i]^polygon [(i + 1) % n];
+	}
+
+	bool inside (true);
+	double result (HUGE_VAL);
+	for (size_t i (0); i < n; ++i)
+	{
+		const point& p (polygon [i]);
+		const point& q (polygon [(i + 1) % n]);
+		if (((q - p)^(v - p))*orientation < 0.0) inside = false;
+		result = std::min (result, segment_dist (v, p, q));
+	}
+	return inside ? 0.0 : result;
+}
+
+//
+// Compact the polygon and check the result;
+// returns true if the case passes
+//
+
+static bool check (search::convex_polygon& cp, double tolerance, int id)
+{
+	cp.convex_hull ();
+	const std::vector<point> old_vertices (vertices (cp));
+	const double bound (cp.compact (tolerance));
+	const std::vector<point> new_vertices (vertices (cp));
+
+	double scale (0.0);
+	for (const point& v : old_vertices) scale = std::max (scale, v.abs ());
+	const double eps (1e-12*(1.0 + scale));
+
+	double hausdorff (0.0);
+	for (const point& v : old_vertices)
+	{
+		hausdorff = std::max (hausdorff, polygon_dist (v, new_vertices));
+	}
+
+	if (bound <= tolerance && hausdorff <= bound + eps) return true;
+
+	std::printf ("case %d: %zu -> %zu vertices, tolerance %g, "
+		"returned %g, distance %g\n", id, old_vertices.size (),
+		new_vertices.size (), tolerance, bound, hausdorff);
+	return false;
+}
+
+int main ()
+{
+	std::mt19937_64 engine (42);
+	std::uniform_real_distribution<double> uniform (0.0, 1.0);
+	const double pi (std::acos (-1.0));
+	int cases (0), failures (0);
+
+	//
+	// Ellipses, every other one thin, with some interior points
+	//
+
+	for (int i (0); i < 3000; ++i)
+	{
+		search::convex_polygon cp;
+		const int n (20 + int (uniform (engine)*800));
+		const double a (0.5 + uniform (engine)*5.0);
+		const double b (i % 2 ?
+			0.001 + uniform (engine)*0.05 : 0.1 + uniform (engine)*3.0);
+
+		for (int k (0); k < n; ++k)
+		{
+			const double t (uniform (engine)*2.0*pi);
+			cp.add_vertex (point (a*std::cos (t), b*std::sin (t)));
+		}
+		if (i % 5 == 0)
+		{
+			for (int k (0); k < n; ++k)
+			{
+				cp.add_vertex (point (
+					(uniform (engine) - 0.5)*a, (uniform (engine) - 0.5)*b));
+			}
+		}
+
+		const double tolerance (std::pow (10.0, -1.0 - 5.0*uniform (engine)));
+		++cases;
+		if (!check (cp, tolerance, i)) ++failures;
+	}
+
+	//
+	// Ellipse 3 x 0.01 with 369 vertices, tolerance 1e-3
+	//
+
+	for (int i (0); i < 200; ++i)
+	{
+		std::mt19937_64 seeded (i);
+		search::convex_polygon cp;
+		for (int k (0); k < 369; ++k)
+		{
+			const double t (uniform (seeded)*2.0*pi);
+			cp.add_vertex (point (3.0*std::cos (t), 0.01*std::sin (t)));
+		}
+		++cases;
+		if (!check (cp, 1e-3, 3000 + i)) ++failures;
+	}
+
+	std::printf ("%d cases, %d failed\n", cases, failures);
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,445 @@
+//
+// pf_test.cpp:
+// Test of convex_polygon_pf on the polygons that broke it,
+// and against a brute-force reference on random, nearly
+// collinear and symmetric polygons.  Every case runs in its
+// own thread and fails if it doesn't finish within the time
+// limit, since the known failures are hangs rather than wrong
+// values.
+//
+// Not a part of the Visual Studio project; build from the
+// repository root, e.g. with MSVC
+//
+//	cl /EHsc /O2 /I. test\pf_test.cpp search.cpp
+//
+// or with g++, which lacks _isnan
+//
+//	g++ -std=c++14 -O2 -pthread -D_isnan=std::isnan -I.
+//		test/pf_test.cpp search.cpp
+//
+// Returns 0 if all the cases pass.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <future>
+#include <random>
+#include <vector>
+
+#include "search.hpp"
+
+typedef search::convex_polygon::point point;
+
+//
+// Run the case in a thread, and return what it returns.
+// A case that doesn't finish in time can't be stopped, so
+// the whole test fails at once.
+//
+
+static bool run (const char* name, const std::function<bool ()>& test_case)
+{
+	const std::chrono::seconds time_limit (10);
+
+	std::future<bool> result (std::async (std::launch::async, test_case));
+
+	if (result.wait_for (time_limit) != std::future_status::ready)
+	{
+		std::printf ("%s: no result in %d s\n",
+			name, int (time_limit.count ()));
+		std::fflush (stdout);
+		std::_Exit (1);
+	}
+
+	if (!result.get ())
+	{
+		std::printf ("%s: failed\n", name);
+		return false;
+	}
+
+	return true;
+}
+
+//
+// Build the perimeter function of the hull of the vertices,
+// check that the whole table of segments is finite, and that
+// maximum() and shortest() agree with the expected maximum
+//
+
+static bool check (const std::vector<point>& vertices, double maximum)
+{
+	search::convex_polygon cp;
+	for (const point& v : vertices) cp.add_vertex (v);
+	cp.convex_hull ();
+
+	search::convex_polygon_pf pf (cp);
+	const unsigned num_segments (pf.num_segments ());
+
+	for (unsigned i = 0; i <= num_segments; ++i)
+	{
+		if (!std::isfinite (pf.a (i))) return false;
+		if (i > 0 && !(std::isfinite (pf.theta (i)) &&
+			std::isfinite (pf.zeta (i)))) return false;
+	}
+
+	bool arc;
+	point start, end, center;
+	const double shortest (pf.shortest (arc, start, end, center));
+
+	search::convex_polygon_pf fresh (cp);
+	const double eps (1e-12*maximum);
+
+	return
+		std::fabs (pf.maximum () - maximum) <= eps &&
+		std::fabs (fresh.maximum () - maximum) <= eps &&
+		std::fabs (shortest - maximum) <= eps;
+}
+
+//
+// Area of the polygon, whatever its orientation
+//
+
+static double polygon_area (const std::vector<point>& polygon)
+{
+	const size_t n (polygon.size ());
+	double result (0.0);
+	for (size_t i (0); i < n; ++i)
+	{
+		result += polygon [i]^polygon [(i + 1) % n];
+	}
+	return std::fabs (result)/2.0;
+}
+
+//
+// Area of the part of the polygon where u*x <= s
+//
+
+static double cut_area (
+	const std::vector<point>& polygon, const point& u, double s)
+{
+	const size_t n (polygon.size ());
+	std::vector<point> part;
+	for (size_t i (0); i < n; ++i)
+	{
+		const point& a (polygon [i]);
+		const point& b (polygon [(i + 1) % n]);
+		const double fa (u*a - s), fb (u*b - s);
+
+		if (fa <= 0.0) part.push_back (a);
+		if ((fa < 0.0 && fb > 0.0) || (fa > 0.0 && fb < 0.0))
+		{
+			part.push_back (a + (b - a)*(fa/(fa - fb)));
+		}
+	}
+	return polygon_area (part);
+}
+
+//
+// Check that the arc with the center r and the radius rho,
+// over the directions from the unit vector e0 counterclockwise
+// to the unit vector e1, lies within the clockwise polygon
+//
+
+static bool arc_inside (const std::vector<point>& polygon,
+	const point& r, double rho, const point& e0, const point& e1, double eps)
+{
+	const size_t n (polygon.size ());
+	double scale (0.0);
+	for (const point& v : polygon) scale = std::max (scale, v.abs ());
+
+	for (size_t i (0); i < n; ++i)
+	{
+		const point& a (polygon [i]);
+		const point d (polygon [(i + 1) % n] - a);
+		const double length (d.abs ());
+		if (length == 0.0) continue;
+
+		// outer normal of the side, and the farthest point
+		// of the arc along it
+		const point normal (point (-d.y, d.x)/length);
+		double reach (std::max (normal*e0, normal*e1));
+		if ((e0^normal) >= 0.0 && (normal^e1) >= 0.0) reach = 1.0;
+
+		if (normal*r + rho*reach > normal*a + eps*(1.0 + scale)) return false;
+	}
+	return true;
+}
+
+//
+// Brute-force perimeter function of the clockwise polygon:
+// the least length, over all the ordered pairs of sides, of
+// the arcs and of the segments between antiparallel sides
+// that cut off the area z.  O(n^3) time.
+//
+
+static double brute_pf (const std::vector<point>& polygon, double z)
+{
+	const double eps (1e-9);
+	const size_t n (polygon.size ());
+	const double area (polygon_area (polygon));
+	if (z > area/2.0) z = area - z;
+
+	double best (HUGE_VAL);
+
+	for (size_t i (0); i < n; ++i)
+	for (size_t j (0); j < n; ++j)
+	{
+		if (i == j) continue;
+
+		const point
+			p1 (polygon [i]), q1 (polygon [(i + 1) % n]),
+			p2 (polygon [j]), q2 (polygon [(j + 1) % n]),
+			d1 (q1 - p1), d2 (q2 - p2);
+		const double l1 (d1.abs ()), l2 (d2.abs ()), cross (d1^d2);
+		if (l1 == 0.0 || l2 == 0.0) continue;
+
+		if (d1*d2 < 0.0 && std::fabs (cross) <= 1e-10*l1*l2)
+		{
+			// antiparallel sides: the segments perpendicular to them
+			if (j < i) continue;
+
+			const point u (d1/l1);
+			const double
+				low (std::max (std::min (u*p1, u*q1), std::min (u*p2, u*q2))),
+				high (std::min (std::max (u*p1, u*q1), std::max (u*p2, u*q2)));
+			if (!(low < high)) continue;
+
+			const double
+				area_low (cut_area (polygon, u, low)),
+				area_high (cut_area (polygon, u, high)),
+				margin (eps*area);
+
+			if ((area_low - margin <= z && z <= area_high + margin) ||
+				(area - area_high - margin <= z &&
+				z <= area - area_low + margin))
+			{
+				best = std::min (best, std::fabs (u^(p2 - p1)));
+			}
+			continue;
+		}
+
+		// the other orientation is the pair (j, i)
+		if (!(cross < 0.0)) continue;
+
+		// apex: the intersection of the lines of the sides,
+		// beyond q1 on the first side and before p2 on the second
+		const bool adjacent ((i + 1) % n == j);
+		const point r (adjacent ? q1 : (d1*(p2^q2) - d2*(p1^q1))/cross);
+		if (!adjacent && ((r - q1)*d1 < -eps*l1*(l1 + (r - q1).abs ()) ||
+			(p2 - r)*d2 < -eps*l2*(l2 + (r - p2).abs ()))) continue;
+
+		const double n0 ((p1 - r).abs ()), n1 ((q2 - r).abs ());
+		if (n0 == 0.0 || n1 == 0.0) continue;
+
+		const point e0 ((p1 - r)/n0), e1 ((q2 - r)/n1);
+		const double theta (std::atan2 (std::fabs (e0^e1), e0*e1));
+
+		// area between the apex and the chain q1, ... , p2
+		double zeta (0.0);
+		if (!adjacent)
+		{
+			std::vector<point> chain (1, r);
+			for (size_t k ((i + 1) % n); ; k = (k + 1) % n)
+			{
+				chain.push_back (polygon [k]);
+				if (k == j) break;
+			}
+			zeta = polygon_area (chain);
+		}
+
+		const double
+			rho_min (adjacent ? 0.0 :
+				std::max ((q1 - r).abs (), (p2 - r).abs ())),
+			rho_max (std::min (n0, n1)),
+			rho (std::sqrt (2.0*(z + zeta)/theta));
+		if (rho < rho_min*(1.0 - eps) || rho > rho_max*(1.0 + eps)) continue;
+
+		const bool counterclockwise ((e0^e1) >= 0.0);
+		if (!arc_inside (polygon, r, rho,
+			counterclockwise ? e0 : e1, counterclockwise ? e1 : e0, eps))
+		{
+			continue;
+		}
+
+		best = std::min (best, rho*theta);
+	}
+
+	return best;
+}
+
+//
+// Build the perimeter function of the hull of the vertices,
+// and check pf() at 20 areas and maximum() against brute_pf()
+// with a relative tolerance of 1e-9
+//
+
+static bool compare (const std::vector<point>& vertices)
+{
+	search::convex_polygon cp;
+	for (const point& v : vertices) cp.add_vertex (v);
+	cp.convex_hull ();
+
+	std::vector<point> polygon;
+	for (auto it (cp.begin ()); it != cp.end (); ++it)
+	{
+		polygon.push_back (*it);
+	}
+
+	search::convex_polygon_pf pf (cp);
+	const double area (polygon_area (polygon));
+
+	for (int k (1); k <= 20; ++k)
+	{
+		const double z (area/2.0*k/20.0), expected (brute_pf (polygon, z));
+		if (!(std::fabs (pf (z) - expected) <= 1e-9*expected)) return false;
+	}
+
+	const double expected (brute_pf (polygon, area/2.0));
+	return std::fabs (pf.maximum () - expected) <= 1e-9*expected;
+}
+
+int main ()
+{
+	std::mt19937_64 engine (42);
+	std::uniform_real_distribution<double> uniform (0.0, 1.0);
+	const double pi (std::acos (-1.0));
+	char name [64];
+	int cases (0), failures (0);
+
+	//
+	// A nearly straight vertex between the sides 3 and 4:
+	// the turn of the pair (4, 3) rounded to less than pi,
+	// while the cross product of the sides gave no apex
+	//
+
+	++cases;
+	if (!run ("nearly straight vertex", []
+		{
+			return check ({
+				point (-4.8788830242368331, -1.4210227421216088),
+				point (-2.4412023909729976, 3.2338932353756604),
+				point (-1.6243027395054102, 4.793818349330019),
+				point (4.55745388118096, 1.421022742121608),
+				point (2.9994729210304625, -1.6801829625127533),
+				point (1.4352475482140308, -4.7938183493300182)},
+				6.9834963698176997);
+		}))
+	{
+		++failures;
+	}
+
+	//
+	// Random polygons inscribed in ellipses
+	//
+
+	for (int i (0); i < 200; ++i)
+	{
+		const int n (3 + int (uniform (engine)*12));
+		const double a (0.5 + uniform (engine)*10.0);
+		const double b (a*(0.3 + uniform (engine)));
+
+		std::vector<point> vertices;
+		for (int k (0); k < n; ++k)
+		{
+			const double t (uniform (engine)*2.0*pi);
+			vertices.push_back (point (a*std::cos (t), b*std::sin (t)));
+		}
+
+		std::snprintf (name, sizeof name, "random %d", i);
+		++cases;
+		if (!run (name, [vertices] { return compare (vertices); }))
+		{
+			++failures;
+		}
+	}
+
+	//
+	// Nearly collinear vertices: random polygons with extra
+	// points on the sides or just off them, and a repeated vertex
+	//
+
+	for (int i (0); i < 200; ++i)
+	{
+		const int n (3 + int (uniform (engine)*8));
+		const double a (0.5 + uniform (engine)*10.0);
+		const double b (a*(0.3 + uniform (engine)));
+
+		std::vector<double> angles;
+		for (int k (0); k < n; ++k)
+		{
+			angles.push_back (uniform (engine)*2.0*pi);
+		}
+		std::sort (angles.begin (), angles.end ());
+
+		std::vector<point> vertices;
+		for (double t : angles)
+		{
+			vertices.push_back (point (a*std::cos (t), b*std::sin (t)));
+		}
+
+		const int extra (1 + int (uniform (engine)*3*n));
+		for (int k (0); k < extra; ++k)
+		{
+			const point& p (vertices [k % n]);
+			const point& q (vertices [(k + 1) % n]);
+			const point outward (point (q.y - p.y, p.x - q.x));
+			const double offset (i % 2 ? 1e-12*(uniform (engine) - 0.5) : 0.0);
+			vertices.push_back (p + (q - p)*uniform (engine) + outward*offset);
+		}
+		vertices.push_back (vertices [0]);
+
+		std::snprintf (name, sizeof name, "nearly collinear %d", i);
+		++cases;
+		if (!run (name, [vertices] { return compare (vertices); }))
+		{
+			++failures;
+		}
+	}
+
+	//
+	// Symmetric polygons: regular ones, rotated and scaled,
+	// and random centrally symmetric ones
+	//
+
+	for (int i (0); i < 60; ++i)
+	{
+		std::vector<point> vertices;
+		const double scale (0.5 + uniform (engine)*10.0);
+
+		if (i < 30)
+		{
+			const int n (3 + i % 15);
+			const double phase (uniform (engine)*2.0*pi);
+			for (int k (0); k < n; ++k)
+			{
+				const double t (phase + 2.0*pi*k/n);
+				vertices.push_back (point (std::cos (t), std::sin (t))*scale);
+			}
+		}
+		else
+		{
+			const int n (2 + int (uniform (engine)*7));
+			for (int k (0); k < n; ++k)
+			{
+				const double t (uniform (engine)*pi);
+				const double radius (scale*(0.5 + uniform (engine)));
+				const point v (radius*std::cos (t), radius*std::sin (t));
+				vertices.push_back (v);
+				vertices.push_back (-v);
+			}
+		}
+
+		std::snprintf (name, sizeof name, "symmetric %d", i);
+		++cases;
+		if (!run (name, [vertices] { return compare (vertices); }))
+		{
+			++failures;
+		}
+	}
+
+	std::printf ("%d cases, %d failed\n", cases, failures);
+	return failures == 0 ? 0 : 1;
+}